@@ -0,0 +1,321 @@
+// bench/door_bench.c
+// /dev/hc_sr04p, /dev/lcd1602 사용자 공간 벤치마크
+// 실제 하드웨어나 시뮬레이터(gpio-sim / i2c-stub, bench/run_sim.sh) 위에서 실행하고
+// 결과를 JSON 또는 CSV로 출력 (한 줄 = device, metric, value, unit)
+//
+// 측정 항목
+//   hc_sr04p: 읽기 지연 백분위 (측정 간격을 두고 한 번씩 읽기), 연속 읽기 샘플/초, 오류율
+//   lcd1602:  프레임(2줄 x 16자) 갱신 시간 (전체 변경 / 두 칸 변경 / mmap 두 칸 변경), 문자/초, ioctl 지연
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+#include "../drivers/ultrasonic/hc_sr04p.h"
+#include "../drivers/lcd/lcd1602.h"
+
+#define LCD_COLS            16
+#define LCD_ROWS            2
+#define SENSOR_GAP_US       70000   // 드라이버 최소 측정 간격(60ms)보다 길게
+#define MAX_METRICS         64
+
+struct metric {
+    const char *device;
+    char name[32];
+    double value;
+    const char *unit;
+};
+
+static struct metric metrics[MAX_METRICS];
+static int metric_count;
+
+static const char *sensor_path = "/dev/hc_sr04p";
+static const char *lcd_path = "/dev/lcd1602";
+static int samples = 100;       // 지연 측정 횟수
+static int duration_s = 5;      // 처리량 측정 시간
+
+static double now_us(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void sleep_us(long us) {
+    struct timespec ts = { us / 1000000, (us % 1000000) * 1000 };
+
+    nanosleep(&ts, NULL);
+}
+
+static void add_metric(const char *device, const char *name, double value, const char *unit) {
+    struct metric *m;
+
+    if (metric_count >= MAX_METRICS)
+        return;
+    m = &metrics[metric_count++];
+    m->device = device;
+    snprintf(m->name, sizeof(m->name), "%s", name);
+    m->value = value;
+    m->unit = unit;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+// 정렬된 값에서 백분위 (nearest-rank)
+static double percentile(const double *sorted, int n, int pct) {
+    int idx = (n * pct + 99) / 100 - 1;
+
+    if (idx < 0)
+        idx = 0;
+    return sorted[idx];
+}
+
+// name_p50/p90/p99/max 기록
+static void add_percentiles(const char *device, const char *name, double *values, int n) {
+    char buf[32];
+
+    if (n <= 0)
+        return;
+    qsort(values, n, sizeof(values[0]), compare_double);
+    snprintf(buf, sizeof(buf), "%s_p50", name);
+    add_metric(device, buf, percentile(values, n, 50), "us");
+    snprintf(buf, sizeof(buf), "%s_p90", name);
+    add_metric(device, buf, percentile(values, n, 90), "us");
+    snprintf(buf, sizeof(buf), "%s_p99", name);
+    add_metric(device, buf, percentile(values, n, 99), "us");
+    snprintf(buf, sizeof(buf), "%s_max", name);
+    add_metric(device, buf, values[n - 1], "us");
+}
+
+static void bench_sensor(void) {
+    const char *dev = "hc_sr04p";
+    struct hc_sr04p_sample sample;
+    double *latency, start, end;
+    unsigned long reads = 0, distinct = 0, errors = 0;
+    __u32 last_seq = 0;
+    int fd, i, n = 0;
+
+    fd = open(sensor_path, O_RDONLY);
+    if (fd < 0 || ioctl(fd, HC_SR04P_IOC_SET_FORMAT, HC_SR04P_FMT_BINARY) < 0) {
+        fprintf(stderr, "%s: %s (skipping)\n", sensor_path, strerror(errno));
+        if (fd >= 0)
+            close(fd);
+        add_metric(dev, "available", 0, "bool");
+        return;
+    }
+    add_metric(dev, "available", 1, "bool");
+
+    // 1. 읽기 지연: 직전 샘플이 재사용되지 않도록 간격을 두고 읽음
+    latency = calloc(samples, sizeof(*latency));
+    if (!latency) {
+        close(fd);
+        return;
+    }
+    for (i = 0; i < samples; i++) {
+        sleep_us(SENSOR_GAP_US);
+        start = now_us();
+        if (read(fd, &sample, sizeof(sample)) != sizeof(sample))
+            continue;
+        latency[n++] = now_us() - start;
+    }
+    add_percentiles(dev, "read_latency", latency, n);
+    add_metric(dev, "read_failures", samples - n, "count");
+    free(latency);
+
+    // 2. 연속 읽기: 같은 샘플을 여러 리더가 공유할 수 있으므로 seq가 바뀐 것만 셈
+    start = now_us();
+    end = start + duration_s * 1e6;
+    while (now_us() < end) {
+        if (read(fd, &sample, sizeof(sample)) != sizeof(sample))
+            continue;
+        reads++;
+        if (distinct && sample.seq == last_seq)
+            continue;
+        last_seq = sample.seq;
+        distinct++;
+        if (sample.status != HC_SR04P_STATUS_OK)
+            errors++;
+    }
+    end = now_us();
+
+    add_metric(dev, "samples_per_sec", distinct / ((end - start) / 1e6), "1/s");
+    add_metric(dev, "reads_per_sec", reads / ((end - start) / 1e6), "1/s");
+    add_metric(dev, "error_rate", distinct ? (double)errors / distinct : 0, "ratio");
+
+    close(fd);
+}
+
+static int lcd_frame(int fd, const char rows[LCD_ROWS][LCD_COLS]) {
+    int row, pos[2];
+
+    for (row = 0; row < LCD_ROWS; row++) {
+        pos[0] = 0;
+        pos[1] = row;
+        if (ioctl(fd, LCD_IOC_SETCURSOR, pos) < 0)
+            return -1;
+        if (write(fd, rows[row], LCD_COLS) != LCD_COLS)
+            return -1;
+    }
+    // 드라이버는 비동기로 전송하므로 패널에 반영될 때까지 기다린 시간까지 포함
+    return fsync(fd);
+}
+
+static void bench_lcd(void) {
+    const char *dev = "lcd1602";
+    char rows[LCD_ROWS][LCD_COLS];
+    double *frame, *cursor, *backlight, start, total = 0;
+    int fd, i, c, n = 0, pos[2] = { 0, 0 };
+    char *fb;
+
+    fd = open(lcd_path, O_RDWR);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s (skipping)\n", lcd_path, strerror(errno));
+        add_metric(dev, "available", 0, "bool");
+        return;
+    }
+    add_metric(dev, "available", 1, "bool");
+
+    frame = calloc(samples, sizeof(*frame));
+    cursor = calloc(samples, sizeof(*cursor));
+    backlight = calloc(samples, sizeof(*backlight));
+    if (!frame || !cursor || !backlight)
+        goto out;
+
+    // 1. 전체 프레임 갱신 (매 프레임 내용이 바뀌도록 문자를 돌림)
+    for (i = 0; i < samples; i++) {
+        for (c = 0; c < LCD_COLS; c++) {
+            rows[0][c] = 'A' + (i + c) % 26;
+            rows[1][c] = '0' + (i + c) % 10;
+        }
+        start = now_us();
+        if (lcd_frame(fd, rows) < 0) {
+            fprintf(stderr, "%s: frame write failed: %s\n", lcd_path, strerror(errno));
+            break;
+        }
+        frame[n] = now_us() - start;
+        total += frame[n++];
+    }
+    if (n)
+        add_metric(dev, "chars_per_sec", n * LCD_ROWS * LCD_COLS / (total / 1e6), "1/s");
+    add_percentiles(dev, "frame_refresh", frame, n);
+
+    // 2. 상태 화면처럼 전체 프레임을 다시 쓰지만 두 칸만 바뀌는 경우
+    for (i = n = 0; i < samples; i++) {
+        rows[0][LCD_COLS - 1] = '0' + i % 10;
+        rows[1][LCD_COLS - 1] = 'a' + i % 26;
+        start = now_us();
+        if (lcd_frame(fd, rows) < 0)
+            break;
+        frame[n++] = now_us() - start;
+    }
+    add_percentiles(dev, "frame_update_2cells", frame, n);
+
+    // 3. 같은 두 칸 변경을 mmap 프레임버퍼에 직접 쓰고 LCD_IOC_SYNC (시스템 호출 한 번)
+    fb = mmap(NULL, LCD1602_FB_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (fb != MAP_FAILED) {
+        for (i = n = 0; i < samples; i++) {
+            start = now_us();
+            fb[LCD_COLS - 1] = '0' + i % 10;
+            fb[LCD1602_FB_SIZE - 1] = 'a' + i % 26;
+            if (ioctl(fd, LCD_IOC_SYNC) < 0)
+                break;
+            frame[n++] = now_us() - start;
+        }
+        add_percentiles(dev, "fb_update_2cells", frame, n);
+        munmap(fb, LCD1602_FB_SIZE);
+    }
+
+    // 4. ioctl 지연 (SETCURSOR, BACKLIGHT)
+    for (i = n = 0; i < samples; i++) {
+        start = now_us();
+        if (ioctl(fd, LCD_IOC_SETCURSOR, pos) < 0)
+            break;
+        cursor[n] = now_us() - start;
+        start = now_us();
+        if (ioctl(fd, LCD_IOC_BACKLIGHT, 1) < 0)
+            break;
+        backlight[n++] = now_us() - start;
+    }
+    add_percentiles(dev, "ioctl_setcursor", cursor, n);
+    add_percentiles(dev, "ioctl_backlight", backlight, n);
+
+out:
+    free(frame);
+    free(cursor);
+    free(backlight);
+    close(fd);
+}
+
+static void print_json(void) {
+    int i;
+
+    printf("{\n  \"samples\": %d,\n  \"duration_s\": %d,\n  \"metrics\": [\n", samples, duration_s);
+    for (i = 0; i < metric_count; i++)
+        printf("    {\"device\": \"%s\", \"metric\": \"%s\", \"value\": %.3f, \"unit\": \"%s\"}%s\n",
+               metrics[i].device, metrics[i].name, metrics[i].value, metrics[i].unit,
+               i + 1 < metric_count ? "," : "");
+    printf("  ]\n}\n");
+}
+
+static void print_csv(void) {
+    int i;
+
+    printf("device,metric,value,unit\n");
+    for (i = 0; i < metric_count; i++)
+        printf("%s,%s,%.3f,%s\n", metrics[i].device, metrics[i].name, metrics[i].value, metrics[i].unit);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-s sensor] [-l lcd] [-n samples] [-d seconds] [-f json|csv]\n"
+            "  -s  ultrasonic device (default /dev/hc_sr04p, \"\" to skip)\n"
+            "  -l  LCD device (default /dev/lcd1602, \"\" to skip)\n"
+            "  -n  latency samples per metric (default 100)\n"
+            "  -d  sustained read duration in seconds (default 5)\n"
+            "  -f  output format (default json)\n", prog);
+}
+
+int main(int argc, char **argv) {
+    const char *format = "json";
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:l:n:d:f:h")) != -1) {
+        switch (opt) {
+        case 's': sensor_path = optarg; break;
+        case 'l': lcd_path = optarg; break;
+        case 'n': samples = atoi(optarg); break;
+        case 'd': duration_s = atoi(optarg); break;
+        case 'f': format = optarg; break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (samples <= 0 || duration_s <= 0 ||
+        (strcmp(format, "json") && strcmp(format, "csv"))) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (*sensor_path)
+        bench_sensor();
+    if (*lcd_path)
+        bench_lcd();
+
+    if (!strcmp(format, "csv"))
+        print_csv();
+    else
+        print_json();
+
+    return 0;
+}
@@ -0,0 +1,38 @@
+#!/bin/sh
+# bench/run_sim.sh
+# i2c-stub(PCF8574 대신)에 i2c_lcd1602_driver.ko를, gpio-sim에 hc_sr04p_driver.ko를 연결하고
+# door_bench를 실행 (root, i2c-stub/gpio-sim 모듈 필요, 인자는 door_bench로 전달)
+set -e
+
+SCRIPT_DIR=$(cd "$(dirname "$0")" && pwd)
+LCD_MODULE=${LCD_MODULE:-$SCRIPT_DIR/../drivers/lcd/i2c_lcd1602_driver.ko}
+LCD_ADDR=0x27
+
+cleanup() {
+    rmmod i2c_lcd1602_driver 2>/dev/null || true
+    rmmod i2c-stub 2>/dev/null || true
+}
+trap cleanup EXIT
+
+if [ ! -f "$LCD_MODULE" ]; then
+    echo "Driver module not found: $LCD_MODULE (build drivers/lcd first)" >&2
+    exit 1
+fi
+
+# i2c-stub는 SMBus 전송만 지원하므로 드라이버가 SMBus send byte 경로를 사용함
+modprobe i2c-stub chip_addr=$LCD_ADDR
+BUS=
+for adapter in /sys/bus/i2c/devices/i2c-*; do
+    if grep -q "SMBus stub driver" "$adapter/name" 2>/dev/null; then
+        BUS=${adapter##*/i2c-}
+    fi
+done
+if [ -z "$BUS" ]; then
+    echo "Cannot find i2c-stub adapter" >&2
+    exit 1
+fi
+
+insmod "$LCD_MODULE" i2c_bus="$BUS" i2c_addr=$LCD_ADDR
+udevadm settle 2>/dev/null || sleep 1
+
+"$SCRIPT_DIR/../tests/ultrasonic/run_sim.sh" "$SCRIPT_DIR/door_bench" "$@"
@@ -10,8 +10,17 @@
 #include <linux/delay.h>
 #include <linux/mutex.h>
 #include <linux/slab.h>    // kzalloc, kfree
+#include <linux/workqueue.h>
+#include <linux/ktime.h>
+#include <linux/mm.h>
+#include <linux/vmalloc.h>
 #include <linux/ioctl.h>   // _IO, _IOW 매크로용
 
+#include "lcd1602.h"
+#include "lcd1602_encode.h"
+#include "lcd1602_shadow.h"
+#include "lcd1602_glyph.h"
+
 // 1602 LCD 전용 설정
 #define DEVICE_NAME "lcd1602"
 #define CLASS_NAME  "lcd"
@@ -20,13 +29,9 @@
 #define LCD_SLAVE_ADDR      0x27
 
 // 1602 LCD 크기 정의
-#define LCD_WIDTH    16
-#define LCD_HEIGHT   2
-#define LCD_MAX_CHARS (LCD_WIDTH * LCD_HEIGHT)
-
-// 1602 LCD 라인 주소
-#define LCD_LINE1_ADDR  0x00
-#define LCD_LINE2_ADDR  0x40
+#define LCD_WIDTH    LCD1602_COLS
+#define LCD_HEIGHT   LCD1602_ROWS
+#define LCD_MAX_CHARS LCD1602_CELLS
 
 // LCD 명령어 정의
 #define LCD_CLEAR_DISPLAY   0x01
@@ -38,19 +43,78 @@
 #define LCD_SET_CGRAM_ADDR  0x40
 #define LCD_SET_DDRAM_ADDR  0x80
 
-// PCF8574 핀 매핑
-#define BACKLIGHT_ON  0x08
-#define BACKLIGHT_OFF 0x00
-#define ENABLE        0x04
-#define READ_WRITE    0x02
-#define REGISTER_SELECT 0x01
+// LCD_CURSOR_SHIFT 옵션
+#define LCD_SHIFT_DISPLAY   0x08    // 커서 대신 화면 전체 이동
+#define LCD_SHIFT_RIGHT     0x04    // 없으면 왼쪽
+
+// HD44780 대기 시간
+#define LCD_BUSY_FLAG       0x80
+#define LCD_BUSY_TIMEOUT_US 10000   // BF가 이 시간 안에 내려오지 않으면 R/W 미연결로 판단
+#define LCD_SLOW_CMD_US     2000    // CLEAR/HOME 최악 실행 시간 (1.52ms @ 270kHz 여유 포함)
+
+#define LCD_REFRESH_MIN_MS  10      // 주기 갱신 최소 간격
+#define LCD_REFRESH_MAX_MS  60000   // 주기 갱신 최대 간격 (unsigned int로 줄이기 전에 검사)
+#define LCD_MARQUEE_MIN_MS  50      // 마퀴 이동 최소 간격 (액정 응답 시간보다 빠르면 번져 보임)
+
+// I2C 버스/주소 (i2c-stub 같은 시뮬레이터에 연결할 때 변경)
+static int i2c_bus = I2C_BUS_AVAILABLE;
+module_param(i2c_bus, int, 0444);
+MODULE_PARM_DESC(i2c_bus, "I2C bus number of the LCD backpack");
+
+static unsigned short i2c_addr = LCD_SLAVE_ADDR;
+module_param(i2c_addr, ushort, 0444);
+MODULE_PARM_DESC(i2c_addr, "I2C address of the PCF8574 backpack");
+
+// 백팩의 P1이 LCD R/W에 연결된 경우에만 사용 가능 (R/W가 GND에 묶인 모듈도 있음)
+static bool busy_flag;
+module_param(busy_flag, bool, 0444);
+MODULE_PARM_DESC(busy_flag, "Poll the HD44780 busy flag instead of fixed worst-case delays");
+
+// 한 번의 flush에서 올릴 수 있는 글리프 명령/데이터 수 (8개 슬롯 전체)
+#define LCD_GLYPH_OPS   (LCD1602_CGRAM_SLOTS * LCD1602_GLYPH_LOAD_OPS)
+#define LCD_FLUSH_OPS   (LCD_GLYPH_OPS + LCD1602_DIFF_MAX_OPS + 1)
+
+// 등록된 글리프 (lock 보호)
+struct lcd_glyph {
+    unsigned int key;       // 0 = 미등록, 등록마다 새 값 (CGRAM 슬롯 식별)
+    unsigned int refs;
+    u8 rows[LCD1602_GLYPH_ROWS];
+};
+
+// 파일별 상태 (open 시 할당)
+// 프로세스가 해제하지 않고 끝나도 release에서 이 fd가 등록한 글리프 참조를 모두 반납
+struct lcd_file {
+    unsigned int glyph_refs[LCD1602_GLYPHS];    // 이 fd가 가진 handle별 참조 수 (lock 보호)
+};
 
 // 드라이버 상태 구조체
 struct lcd1602_data {
     struct i2c_client *client;
-    struct mutex lock;
-    int cursor_col;
+    bool raw_i2c;       // 어댑터가 일반 I2C 전송을 지원 (아니면 SMBus send byte 사용)
+    bool busy_poll;     // busy flag 읽기 사용 (응답이 없으면 고정 대기로 되돌림)
+    u16 max_write;      // 어댑터의 I2C 쓰기 길이 제한, 0 = 제한 없음
+    u8 tx_buf[LCD_FLUSH_OPS * LCD1602_BYTE_BYTES];  // 인코딩된 전송 버퍼 (io_lock 보호)
+    struct mutex lock;          // frame/커서 상태 (write/ioctl은 이 락만 잡고 바로 반환)
+    int cursor_col;     // 다음 문자를 쓸 frame 위치
     int cursor_row;
+    u8 *frame;                  // 원하는 화면 (write/ioctl과 mmap 사용자 공간이 수정, 한 페이지)
+    int flush_err;              // 마지막 flush 오류 (fsync/LCD_IOC_SYNC가 보고하고 지움)
+    struct work_struct flush_work;  // frame을 패널로 전송하는 작업
+    unsigned int refresh_ms;    // 주기 갱신 간격, 0 = 끔
+    struct delayed_work refresh_work;
+    struct lcd_glyph glyphs[LCD1602_GLYPHS];
+    unsigned int glyph_key;     // 마지막으로 발급한 글리프 key
+    bool port_dirty;            // 백라이트가 바뀜 (바뀐 칸이 없어도 포트 바이트를 한 번 씀)
+    
+    // 락 순서: io_lock → lock (flush 작업만 둘 다 잡음)
+    struct mutex io_lock;       // 패널 전송 상태 (shadow, ac, cgram, tx_buf)
+    struct lcd1602_cgram cgram; // CGRAM 슬롯에 올라간 글리프
+    unsigned int cgram_tick;    // flush마다 증가 (슬롯 LRU 기준)
+    unsigned int marquee_ms;    // 마퀴 이동 간격, 0 = 끔 (켜져 있으면 flush는 패널을 건드리지 않음)
+    struct delayed_work marquee_work;
+    u8 shadow[LCD_MAX_CHARS];   // 패널 DDRAM 사본 (바뀐 칸만 전송하기 위해 비교)
+    bool shadow_valid;          // 전송 실패 후에는 패널 내용을 알 수 없음
+    int ac;                     // 패널 주소 카운터, -1 = 모름
     bool backlight;
     bool display_on;
     bool cursor_on;
@@ -81,89 +145,450 @@ static int lcd_dev_uevent(const struct device *dev, struct kobj_uevent_env *env)
     return 0;
 }
 
-// 4비트 모드로 데이터 전송
-static int lcd_write_nibble(u8 data, u8 control)
+// PCF8574로 바이트 전송
+// PCF8574는 한 트랜잭션 안의 바이트를 차례로 포트에 출력하므로 가능한 한 번에 보냄
+// (어댑터 제한이 있으면 나눠 보내도 바이트 사이 간격만 늘어날 뿐 의미는 같음)
+// SMBus만 지원하는 어댑터(i2c-stub 등)에서는 바이트마다 SMBus send byte로 전송
+static int lcd_i2c_send(const u8 *buf, int len)
 {
-    u8 buffer;
-    int ret;
+    int i, chunk, ret;
+    
+    if (lcd_data->raw_i2c) {
+        while (len > 0) {
+            chunk = len;
+            if (lcd_data->max_write && chunk > lcd_data->max_write)
+                chunk = lcd_data->max_write;
+            ret = i2c_master_send(lcd_data->client, buf, chunk);
+            if (ret != chunk)
+                return ret < 0 ? ret : -EIO;
+            buf += chunk;
+            len -= chunk;
+        }
+        return 0;
+    }
     
-    buffer = (data & 0xF0) | control;
-    if (lcd_data->backlight) buffer |= BACKLIGHT_ON;
+    for (i = 0; i < len; i++) {
+        ret = i2c_smbus_write_byte(lcd_data->client, buf[i]);
+        if (ret) return ret;
+    }
     
-    ret = i2c_master_send(lcd_data->client, &buffer, 1);
-    if (ret != 1) return -EIO;
+    return 0;
+}
+
+// PCF8574 포트 읽기
+static int lcd_i2c_recv(u8 *value)
+{
+    int ret;
     
-    buffer |= ENABLE;
-    ret = i2c_master_send(lcd_data->client, &buffer, 1);
-    if (ret != 1) return -EIO;
-    udelay(1);
+    if (lcd_data->raw_i2c) {
+        ret = i2c_master_recv(lcd_data->client, value, 1);
+        return ret == 1 ? 0 : (ret < 0 ? ret : -EIO);
+    }
     
-    buffer &= ~ENABLE;
-    ret = i2c_master_send(lcd_data->client, &buffer, 1);
-    if (ret != 1) return -EIO;
-    udelay(50);
+    ret = i2c_smbus_read_byte(lcd_data->client);
+    if (ret < 0) return ret;
+    *value = ret;
     
     return 0;
 }
 
-// LCD 명령어 전송
-static int lcd_write_command(u8 cmd)
+// busy flag 읽기: 1 = 처리 중, 0 = 준비됨
+// D7~D4를 1로 써서 PCF8574 핀을 입력으로 만들고 R/W=1로 EN을 올린 동안 포트를 읽음
+// 4비트 모드에서는 상위(BF 포함)/하위 니블을 모두 클럭해야 다음 읽기/쓰기가 어긋나지 않음
+static int lcd_read_busy(void)
 {
+    u8 idle = 0xF0 | LCD1602_RW | (lcd_data->backlight ? LCD1602_BACKLIGHT : 0);
+    u8 high[2] = { idle, idle | LCD1602_ENABLE };
+    u8 low[3] = { idle, idle | LCD1602_ENABLE, idle };
+    u8 status;
     int ret;
     
-    ret = lcd_write_nibble(cmd, 0);
+    ret = lcd_i2c_send(high, sizeof(high));
     if (ret) return ret;
-    
-    ret = lcd_write_nibble(cmd << 4, 0);
+    ret = lcd_i2c_recv(&status);
+    if (ret) return ret;
+    ret = lcd_i2c_send(low, sizeof(low));
     if (ret) return ret;
     
-    if (cmd == LCD_CLEAR_DISPLAY || cmd == LCD_RETURN_HOME) {
-        mdelay(2);
-        lcd_data->cursor_col = 0;
-        lcd_data->cursor_row = 0;
+    return !!(status & LCD_BUSY_FLAG);
+}
+
+// CLEAR/HOME 같은 느린 명령이 끝날 때까지 대기 (busy flag 또는 최악 시간만큼 sleep)
+static int lcd_wait_slow(void)
+{
+    ktime_t deadline;
+    int ret;
+    
+    if (lcd_data->busy_poll) {
+        deadline = ktime_add_us(ktime_get(), LCD_BUSY_TIMEOUT_US);
+        for (;;) {
+            ret = lcd_read_busy();
+            if (ret <= 0)
+                return ret;
+            if (ktime_after(ktime_get(), deadline))
+                break;
+            usleep_range(100, 200);
+        }
+        
+        // R/W가 연결되지 않으면 풀업 때문에 BF가 항상 1로 읽힘
+        pr_warn("LCD busy flag stuck, falling back to fixed delays\n");
+        lcd_data->busy_poll = false;
+        return 0;
     }
     
+    usleep_range(LCD_SLOW_CMD_US, LCD_SLOW_CMD_US + 500);
     return 0;
 }
 
-// LCD 데이터 전송
-static int lcd_write_data(u8 data)
+// 4비트 모드로 니블 하나 전송 (초기화 시퀀스 전용)
+static int lcd_write_nibble(u8 data, u8 control)
 {
+    u8 buffer[LCD1602_NIBBLE_BYTES];
     int ret;
     
-    ret = lcd_write_nibble(data, REGISTER_SELECT);
-    if (ret) return ret;
+    lcd1602_encode_nibble(buffer, data, control, lcd_data->backlight);
     
-    ret = lcd_write_nibble(data << 4, REGISTER_SELECT);
+    ret = lcd_i2c_send(buffer, LCD1602_NIBBLE_BYTES);
     if (ret) return ret;
+    usleep_range(50, 100);
+    
+    return 0;
+}
+
+// 1.52ms가 걸리는 명령 (뒤에서 전송을 끊고 기다려야 함)
+static bool lcd_is_slow_op(const struct lcd1602_op *op)
+{
+    return !op->control && (op->value == LCD_CLEAR_DISPLAY || op->value == LCD_RETURN_HOME);
+}
+
+// 명령/데이터 배열을 한 버퍼로 인코딩해서 전송 (느린 명령 뒤에서만 끊음)
+// 일반 명령(37μs)은 다음 EN 펄스까지의 버스 시간이 더 길어서 따로 기다리지 않음
+static int lcd_send_ops(const struct lcd1602_op *ops, unsigned int n)
+{
+    unsigned int start, end;
+    int ret;
+    
+    for (start = 0; start < n; start = end) {
+        end = start;
+        while (end < n && !lcd_is_slow_op(&ops[end++]))
+            ;
+        
+        ret = lcd_i2c_send(lcd_data->tx_buf,
+                           lcd1602_encode_ops(lcd_data->tx_buf, &ops[start], end - start,
+                                              lcd_data->backlight));
+        if (ret) return ret;
+        
+        if (lcd_is_slow_op(&ops[end - 1])) {
+            ret = lcd_wait_slow();
+            if (ret) return ret;
+        }
+    }
+    
+    return 0;
+}
+
+// LCD 명령어 전송
+static int lcd_write_command(u8 cmd)
+{
+    struct lcd1602_op op = { cmd, 0 };
+    
+    return lcd_send_ops(&op, 1);
+}
+
+// 커서 위치 설정 (frame 위치만 바꾸고 패널에는 flush 때 반영)
+static int lcd_set_cursor(int col, int row)
+{
+    if (col < 0 || col >= LCD_WIDTH || row < 0 || row >= LCD_HEIGHT)
+        return -EINVAL;
+    
+    lcd_data->cursor_col = col;
+    lcd_data->cursor_row = row;
+    
+    return 0;
+}
+
+// frame의 현재 커서 위치에 문자를 넣고 커서 이동
+static void lcd_put_char(u8 c)
+{
+    lcd_data->frame[lcd_data->cursor_row * LCD_WIDTH + lcd_data->cursor_col] = c;
     
-    // 커서 위치 업데이트 
     lcd_data->cursor_col++;
     if (lcd_data->cursor_col >= LCD_WIDTH) {
         lcd_data->cursor_col = 0;
         lcd_data->cursor_row = (lcd_data->cursor_row + 1) % LCD_HEIGHT;
     }
+}
+
+// frame 지우기 (커서는 처음으로)
+static void lcd_clear_frame(void)
+{
+    memset(lcd_data->frame, ' ', LCD_MAX_CHARS);
+    lcd_data->cursor_col = 0;
+    lcd_data->cursor_row = 0;
+}
+
+// frame의 글리프 handle을 CGRAM 슬롯 코드로 바꾸고, 슬롯에 없는 글리프의 업로드 순서를 ops에 기록
+// (io_lock, lock 보유)
+static unsigned int lcd_resolve_glyphs(u8 *frame, struct lcd1602_op *ops)
+{
+    struct lcd_glyph *glyph;
+    unsigned int i, r, n = 0, pinned = 0, dropped = 0;
+    int slot, load;
+    
+    lcd_data->cgram_tick++;
+    
+    for (i = 0; i < LCD_MAX_CHARS; i++) {
+        // 0x00~0x0F는 LRU가 관리하는 CGRAM 슬롯 (0x08~는 0x00~의 미러)이라
+        // 프레임버퍼에 직접 쓴 값은 어떤 글리프가 나올지 모르므로 공백으로 표시
+        if (frame[i] < 0x20) {
+            frame[i] = ' ';
+            continue;
+        }
+        if (frame[i] < LCD1602_GLYPH_BASE || frame[i] >= LCD1602_GLYPH(LCD1602_GLYPHS))
+            continue;
+        
+        glyph = &lcd_data->glyphs[frame[i] - LCD1602_GLYPH_BASE];
+        slot = -1;
+        if (glyph->key)
+            slot = lcd1602_cgram_slot(&lcd_data->cgram, glyph->key, pinned,
+                                      lcd_data->cgram_tick, &load);
+        if (slot < 0) {
+            // 해제된 handle이거나 한 화면에 서로 다른 글리프가 8개를 넘음
+            dropped += !!glyph->key;
+            frame[i] = ' ';
+            continue;
+        }
+        
+        pinned |= 1u << slot;
+        frame[i] = slot;
+        if (!load)
+            continue;
+        
+        ops[n].value = LCD_SET_CGRAM_ADDR | (slot << 3);
+        ops[n++].control = 0;
+        for (r = 0; r < LCD1602_GLYPH_ROWS; r++) {
+            ops[n].value = glyph->rows[r];
+            ops[n++].control = LCD1602_RS;
+        }
+    }
+    
+    if (dropped)
+        pr_warn_ratelimited("LCD frame uses more than %d glyphs, %u cells blanked\n",
+                            LCD1602_CGRAM_SLOTS, dropped);
+    
+    return n;
+}
+
+// frame과 shadow를 비교해 바뀐 칸만 패널에 전송 (io_lock 보유)
+// glyph_ops: 먼저 보낼 CGRAM 업로드 (lcd_resolve_glyphs 결과)
+// cursor_cell: 커서를 표시할 칸, -1이면 커서를 옮기지 않음
+// port_dirty: 보낼 명령이 없어도 백라이트 비트를 반영한 포트 바이트를 씀
+static int lcd_flush(const u8 *frame, const struct lcd1602_op *glyph_ops, unsigned int nglyph,
+                     int cursor_cell, bool port_dirty)
+{
+    struct lcd1602_op ops[LCD_FLUSH_OPS];
+    unsigned int n;
+    int ac = lcd_data->ac;
+    int cursor_addr, ret;
+    
+    // CGRAM 쓰기 후 주소 카운터는 CGRAM을 가리키므로 DDRAM 주소를 다시 지정해야 함
+    memcpy(ops, glyph_ops, nglyph * sizeof(*ops));
+    if (nglyph)
+        ac = -1;
+    
+    n = nglyph + lcd1602_diff(ops + nglyph, lcd_data->shadow, frame, !lcd_data->shadow_valid, &ac);
+    
+    // 커서가 보일 때만 주소 카운터를 논리 커서 위치로 옮김
+    if (cursor_cell >= 0) {
+        cursor_addr = lcd1602_cell_addr(cursor_cell);
+        if (ac != cursor_addr) {
+            ops[n].value = LCD_SET_DDRAM_ADDR | cursor_addr;
+            ops[n++].control = 0;
+            ac = cursor_addr;
+        }
+    }
+    
+    // 바뀐 칸 전체를 I2C 쓰기 한 번으로 전송 (모든 바이트에 현재 백라이트 비트가 들어감)
+    if (n) {
+        ret = lcd_send_ops(ops, n);
+    } else if (port_dirty) {
+        // EN이 LOW라 LCD는 무시하고 PCF8574 백라이트 출력만 바뀜
+        lcd_data->tx_buf[0] = lcd_data->backlight ? LCD1602_BACKLIGHT : 0;
+        ret = lcd_i2c_send(lcd_data->tx_buf, 1);
+    } else {
+        ret = 0;
+    }
+    if (ret) {
+        // 어디까지 전송됐는지 모르므로 다음 flush는 전체를 다시 씀
+        lcd_data->shadow_valid = false;
+        lcd_data->ac = -1;
+        lcd1602_cgram_reset(&lcd_data->cgram);
+        return ret;
+    }
+    
+    memcpy(lcd_data->shadow, frame, sizeof(lcd_data->shadow));
+    lcd_data->shadow_valid = true;
+    lcd_data->ac = ac;
     
     return 0;
 }
 
-// 커서 위치 설정 
-static int lcd_set_cursor(int col, int row)
+// flush 작업: 실행 시점의 최신 frame만 전송하므로 그 사이의 중간 프레임은 건너뜀
+// (전송 중에 들어온 write는 작업을 다시 예약하므로 마지막 내용은 항상 반영됨)
+static void lcd_flush_work(struct work_struct *work)
 {
-    u8 addr;
+    u8 frame[LCD_MAX_CHARS];
+    struct lcd1602_op glyph_ops[LCD_GLYPH_OPS];
+    unsigned int nglyph;
+    int cursor_cell = -1;
+    bool port_dirty;
+    int ret;
     
-    if (col >= LCD_WIDTH || row >= LCD_HEIGHT)
-        return -EINVAL;
+    mutex_lock(&lcd_data->io_lock);
     
-    if (row == 0)
-        addr = LCD_LINE1_ADDR + col;
-    else
-        addr = LCD_LINE2_ADDR + col;
+    // 마퀴 중에는 frame을 보관만 하고 마퀴를 끌 때 다시 그림
+    if (lcd_data->marquee_ms) {
+        mutex_unlock(&lcd_data->io_lock);
+        return;
+    }
     
-    lcd_data->cursor_col = col;
-    lcd_data->cursor_row = row;
+    // mmap 사용자는 락 없이 쓰므로 한 번 복사한 내용을 기준으로 비교/전송
+    mutex_lock(&lcd_data->lock);
+    memcpy(frame, lcd_data->frame, sizeof(frame));
+    nglyph = lcd_resolve_glyphs(frame, glyph_ops);
+    if (lcd_data->cursor_on || lcd_data->blink_on)
+        cursor_cell = lcd_data->cursor_row * LCD_WIDTH + lcd_data->cursor_col;
+    port_dirty = lcd_data->port_dirty;
+    lcd_data->port_dirty = false;
+    mutex_unlock(&lcd_data->lock);
+    
+    ret = lcd_flush(frame, glyph_ops, nglyph, cursor_cell, port_dirty);
+    mutex_unlock(&lcd_data->io_lock);
+    
+    if (ret) {
+        pr_err("LCD flush failed: %d\n", ret);
+        mutex_lock(&lcd_data->lock);
+        lcd_data->flush_err = ret;
+        mutex_unlock(&lcd_data->lock);
+    }
+}
+
+// frame 변경 후 호출 (lock 보유 여부 무관)
+static void lcd_schedule_flush(void)
+{
+    queue_work(system_long_wq, &lcd_data->flush_work);
+}
+
+// 주기 갱신: mmap으로 바뀐 내용을 flush 작업으로 넘김 (바뀐 칸이 없으면 I2C 전송 없음)
+static void lcd_refresh_work(struct work_struct *work)
+{
+    unsigned int ms;
+    
+    mutex_lock(&lcd_data->lock);
+    ms = lcd_data->refresh_ms;
+    mutex_unlock(&lcd_data->lock);
+    
+    if (!ms)
+        return;
+    
+    lcd_schedule_flush();
+    queue_delayed_work(system_long_wq, &lcd_data->refresh_work, msecs_to_jiffies(ms));
+}
+
+// 마퀴 한 단계: 디스플레이 시프트 명령 하나 (DDRAM 내용은 그대로)
+static void lcd_marquee_work(struct work_struct *work)
+{
+    int ret;
+    
+    mutex_lock(&lcd_data->io_lock);
+    if (lcd_data->marquee_ms) {
+        ret = lcd_write_command(LCD_CURSOR_SHIFT | LCD_SHIFT_DISPLAY);
+        if (ret)
+            pr_err_ratelimited("LCD marquee shift failed: %d\n", ret);
+        queue_delayed_work(system_long_wq, &lcd_data->marquee_work,
+                           msecs_to_jiffies(lcd_data->marquee_ms));
+    }
+    mutex_unlock(&lcd_data->io_lock);
+}
+
+// 마퀴 시작/중지 (step_ms = 0이면 중지)
+static int lcd_marquee(const struct lcd1602_marquee *marquee)
+{
+    struct lcd1602_op ops[LCD_HEIGHT * (1 + LCD1602_DDRAM_COLS) + 1];
+    unsigned int n = 0, row, col;
+    bool end, running;
+    int ret;
+    
+    BUILD_BUG_ON(ARRAY_SIZE(ops) > LCD_FLUSH_OPS);  // tx_buf 크기
+    
+    mutex_lock(&lcd_data->io_lock);
+    
+    if (!marquee->step_ms) {
+        if (!lcd_data->marquee_ms) {
+            mutex_unlock(&lcd_data->io_lock);
+            return 0;
+        }
+        // 대기 중인 단계는 marquee_ms == 0을 보고 그냥 끝남
+        lcd_data->marquee_ms = 0;
+        cancel_delayed_work(&lcd_data->marquee_work);
+        ops[n].value = LCD_RETURN_HOME;     // 시프트 원위치
+        ops[n++].control = 0;
+    } else {
+        // 행마다 40칸 DDRAM 전체를 쓰고 시프트 원위치에서 시작
+        for (row = 0; row < LCD_HEIGHT; row++) {
+            ops[n].value = LCD_SET_DDRAM_ADDR | lcd1602_cell_addr(row * LCD_WIDTH);
+            ops[n++].control = 0;
+            for (col = 0, end = false; col < LCD1602_DDRAM_COLS; col++) {
+                u8 c = marquee->text[row][col];
+                
+                end = end || !c;
+                ops[n].value = (end || c < 0x20 || c > 0x7F) ? ' ' : c;
+                ops[n++].control = LCD1602_RS;
+            }
+        }
+        ops[n].value = LCD_RETURN_HOME;
+        ops[n++].control = 0;
+    }
     
-    return lcd_write_command(LCD_SET_DDRAM_ADDR | addr);
+    ret = lcd_send_ops(ops, n);
+    
+    // 화면 밖 DDRAM과 시프트 상태가 바뀌었으므로 일반 화면은 전체를 다시 그림
+    lcd_data->shadow_valid = false;
+    lcd_data->ac = -1;
+    
+    running = !ret && marquee->step_ms;
+    if (running) {
+        lcd_data->marquee_ms = max_t(u32, marquee->step_ms, LCD_MARQUEE_MIN_MS);
+        mod_delayed_work(system_long_wq, &lcd_data->marquee_work,
+                         msecs_to_jiffies(lcd_data->marquee_ms));
+    } else {
+        // 시작에 실패해도 일반 화면으로 복귀
+        lcd_data->marquee_ms = 0;
+    }
+    
+    mutex_unlock(&lcd_data->io_lock);
+    
+    if (!running)
+        lcd_schedule_flush();
+    
+    return ret;
+}
+
+// 지금까지의 frame 변경이 패널에 반영될 때까지 대기하고 그 사이 전송 오류를 반환
+// (mmap으로 바뀐 내용은 커널이 알 수 없으므로 항상 flush를 새로 예약)
+static int lcd_sync(void)
+{
+    int ret;
+    
+    lcd_schedule_flush();
+    flush_work(&lcd_data->flush_work);
+    
+    mutex_lock(&lcd_data->lock);
+    ret = lcd_data->flush_err;
+    lcd_data->flush_err = 0;
+    mutex_unlock(&lcd_data->lock);
+    
+    return ret;
 }
 
 // 1602 LCD 초기화 
@@ -171,20 +596,20 @@ static int lcd_init(void)
 {
     int ret;
     
-    mdelay(50);
+    msleep(50);
     
-    // 4비트 모드 설정 시퀀스
+    // 4비트 모드 설정 시퀀스 (4비트 모드 전에는 busy flag를 읽을 수 없어 고정 대기)
     ret = lcd_write_nibble(0x30, 0);
     if (ret) return ret;
-    mdelay(5);
+    usleep_range(4100, 5000);
     
     ret = lcd_write_nibble(0x30, 0);
     if (ret) return ret;
-    udelay(150);
+    usleep_range(150, 300);
     
     ret = lcd_write_nibble(0x30, 0);
     if (ret) return ret;
-    udelay(150);
+    usleep_range(150, 300);
     
     ret = lcd_write_nibble(0x20, 0);
     if (ret) return ret;
@@ -205,9 +630,12 @@ static int lcd_init(void)
     ret = lcd_write_command(LCD_ENTRY_MODE_SET | 0x02);
     if (ret) return ret;
     
-    // 상태 초기화
-    lcd_data->cursor_col = 0;
-    lcd_data->cursor_row = 0;
+    // 상태 초기화 (화면 지우기 후 DDRAM은 모두 공백, 주소 카운터는 0)
+    lcd_clear_frame();
+    memcpy(lcd_data->shadow, lcd_data->frame, LCD_MAX_CHARS);
+    lcd_data->shadow_valid = true;
+    lcd_data->ac = 0;
+    lcd1602_cgram_reset(&lcd_data->cgram);
     lcd_data->backlight = true;
     lcd_data->display_on = true;
     lcd_data->cursor_on = false;
@@ -216,13 +644,91 @@ static int lcd_init(void)
     return 0;
 }
 
+// 글리프 등록: 같은 비트맵이 이미 있으면 그 handle의 참조 카운트만 증가 (lock 보유)
+static int lcd_glyph_register(const u8 *rows)
+{
+    struct lcd_glyph *glyph;
+    int h, free_h = -1;
+    
+    for (h = 0; h < LCD1602_GLYPHS; h++) {
+        glyph = &lcd_data->glyphs[h];
+        if (!glyph->key) {
+            if (free_h < 0)
+                free_h = h;
+            continue;
+        }
+        if (!memcmp(glyph->rows, rows, LCD1602_GLYPH_ROWS)) {
+            glyph->refs++;
+            return h;
+        }
+    }
+    
+    if (free_h < 0)
+        return -ENOSPC;
+    
+    glyph = &lcd_data->glyphs[free_h];
+    memcpy(glyph->rows, rows, LCD1602_GLYPH_ROWS);
+    glyph->refs = 1;
+    glyph->key = ++lcd_data->glyph_key;
+    if (!glyph->key)    // 0은 빈 슬롯 표시
+        glyph->key = ++lcd_data->glyph_key;
+    
+    return free_h;
+}
+
+// 글리프 참조 하나 반납, 마지막 참조면 handle 해제 (lock 보유)
+// 반환값: 해제되었으면 true (화면에 남은 칸은 다음 flush에서 공백)
+static bool lcd_glyph_put(int h)
+{
+    if (--lcd_data->glyphs[h].refs)
+        return false;
+    
+    lcd_data->glyphs[h].key = 0;
+    return true;
+}
+
+// 파일 연산 - open
+static int lcd_open(struct inode *inode, struct file *file)
+{
+    struct lcd_file *priv;
+    
+    priv = kzalloc(sizeof(*priv), GFP_KERNEL);
+    if (!priv)
+        return -ENOMEM;
+    
+    file->private_data = priv;
+    return 0;
+}
+
+// 파일 연산 - release (이 fd가 등록한 글리프 참조 반납)
+static int lcd_release(struct inode *inode, struct file *file)
+{
+    struct lcd_file *priv = file->private_data;
+    bool freed = false;
+    int h;
+    
+    mutex_lock(&lcd_data->lock);
+    for (h = 0; h < LCD1602_GLYPHS; h++) {
+        while (priv->glyph_refs[h]) {
+            priv->glyph_refs[h]--;
+            freed |= lcd_glyph_put(h);
+        }
+    }
+    mutex_unlock(&lcd_data->lock);
+    
+    if (freed)
+        lcd_schedule_flush();
+    
+    kfree(priv);
+    return 0;
+}
+
 // 파일 연산 - write 
 static ssize_t lcd_write(struct file *file, const char __user *buf,
                         size_t len, loff_t *ppos)
 {
-    char kernel_buf[LCD_MAX_CHARS + 1];
-    int i, ret;
-    ssize_t written = 0;
+    u8 kernel_buf[LCD_MAX_CHARS + 1];
+    int i, ret = 0;
     
     if (len > LCD_MAX_CHARS)
         len = LCD_MAX_CHARS;
@@ -232,76 +738,71 @@ static ssize_t lcd_write(struct file *file, const char __user *buf,
     
     mutex_lock(&lcd_data->lock);
     
+    // frame만 수정하고 전송은 flush 작업에 맡김
     for (i = 0; i < len; i++) {
         switch (kernel_buf[i]) {
         case '\n':
             // 다음 줄로 이동
-            if (lcd_data->cursor_row == 0) {
-                ret = lcd_set_cursor(0, 1);
-            } else {
-                ret = lcd_set_cursor(0, 0);
-            }
+            lcd_set_cursor(0, lcd_data->cursor_row == 0 ? 1 : 0);
             break;
         case '\r':
             // 현재 줄의 처음으로 이동
-            ret = lcd_set_cursor(0, lcd_data->cursor_row);
+            lcd_set_cursor(0, lcd_data->cursor_row);
             break;
         case '\f':
             // 화면 지우기
-            ret = lcd_write_command(LCD_CLEAR_DISPLAY);
+            lcd_clear_frame();
             break;
         case '\b':
             // 백스페이스
             if (lcd_data->cursor_col > 0) {
-                ret = lcd_set_cursor(lcd_data->cursor_col - 1, 
-                                   lcd_data->cursor_row);
-                if (!ret) ret = lcd_write_data(' ');
-                if (!ret) ret = lcd_set_cursor(lcd_data->cursor_col - 1,
-                                             lcd_data->cursor_row);
+                lcd_data->cursor_col--;
+                lcd_data->frame[lcd_data->cursor_row * LCD_WIDTH + lcd_data->cursor_col] = ' ';
             }
             break;
         default:
-            if (kernel_buf[i] >= 0x20 && kernel_buf[i] <= 0x7F) {
-                ret = lcd_write_data(kernel_buf[i]);
+            // ASCII 또는 등록된 글리프 handle (LCD1602_GLYPH(h))
+            if ((kernel_buf[i] >= 0x20 && kernel_buf[i] <= 0x7F) ||
+                (kernel_buf[i] >= LCD1602_GLYPH_BASE &&
+                 kernel_buf[i] < LCD1602_GLYPH(LCD1602_GLYPHS))) {
+                lcd_put_char(kernel_buf[i]);
             }
             break;
         }
-        
-        if (ret) {
-            mutex_unlock(&lcd_data->lock);
-            return ret;
-        }
-        written++;
     }
     
+    lcd_schedule_flush();
     mutex_unlock(&lcd_data->lock);
-    return written;
+    
+    // O_SYNC/O_DSYNC로 열었으면 패널에 반영될 때까지 대기
+    if (file->f_flags & O_DSYNC) {
+        ret = lcd_sync();
+        if (ret)
+            return ret;
+    }
+    
+    return len;
 }
 
-// IOCTL 명령어 정의 
-#define LCD_IOC_MAGIC  'L'
-#define LCD_IOC_CLEAR       _IO(LCD_IOC_MAGIC, 1)
-#define LCD_IOC_HOME        _IO(LCD_IOC_MAGIC, 2)
-#define LCD_IOC_SETCURSOR   _IOW(LCD_IOC_MAGIC, 3, int[2])
-#define LCD_IOC_BACKLIGHT   _IOW(LCD_IOC_MAGIC, 4, int)
-#define LCD_IOC_DISPLAY     _IOW(LCD_IOC_MAGIC, 5, int)
-
 // IOCTL 함수 
 static long lcd_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 {
+    struct lcd_file *priv = file->private_data;
     int ret = 0;
     int params[2];
     
     switch (cmd) {
     case LCD_IOC_CLEAR:
         mutex_lock(&lcd_data->lock);
-        ret = lcd_write_command(LCD_CLEAR_DISPLAY);
+        lcd_clear_frame();
+        lcd_schedule_flush();
         mutex_unlock(&lcd_data->lock);
         break;
         
     case LCD_IOC_HOME:
         mutex_lock(&lcd_data->lock);
-        ret = lcd_write_command(LCD_RETURN_HOME);
+        lcd_set_cursor(0, 0);
+        lcd_schedule_flush();
         mutex_unlock(&lcd_data->lock);
         break;
         
@@ -310,12 +811,87 @@ static long lcd_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
             return -EFAULT;
         mutex_lock(&lcd_data->lock);
         ret = lcd_set_cursor(params[0], params[1]);
+        if (!ret)
+            lcd_schedule_flush();   // 바뀐 칸이 없으면 커서 표시만 갱신
         mutex_unlock(&lcd_data->lock);
         break;
         
     case LCD_IOC_BACKLIGHT:
+        // 백라이트 비트는 전송하는 모든 바이트에 실리므로 frame이 그대로면 flush가 포트만 다시 씀
         mutex_lock(&lcd_data->lock);
-        lcd_data->backlight = !!arg;
+        if (lcd_data->backlight != !!arg) {
+            WRITE_ONCE(lcd_data->backlight, !!arg);
+            lcd_data->port_dirty = true;
+            lcd_schedule_flush();
+        }
+        mutex_unlock(&lcd_data->lock);
+        break;
+        
+    case LCD_IOC_SYNC:
+        ret = lcd_sync();
+        break;
+        
+    case LCD_IOC_GLYPH_REGISTER: {
+        struct lcd1602_glyph glyph;
+        int i;
+        
+        if (copy_from_user(&glyph, (void __user *)arg, sizeof(glyph)))
+            return -EFAULT;
+        for (i = 0; i < LCD1602_GLYPH_ROWS; i++)
+            glyph.rows[i] &= 0x1F;
+        
+        mutex_lock(&lcd_data->lock);
+        ret = lcd_glyph_register(glyph.rows);
+        if (ret >= 0)
+            priv->glyph_refs[ret]++;
+        mutex_unlock(&lcd_data->lock);
+        if (ret < 0)
+            break;
+        
+        glyph.handle = ret;
+        ret = 0;
+        if (copy_to_user((void __user *)arg, &glyph, sizeof(glyph)))
+            ret = -EFAULT;
+        break;
+    }
+        
+    case LCD_IOC_MARQUEE: {
+        struct lcd1602_marquee marquee;
+        
+        if (copy_from_user(&marquee, (void __user *)arg, sizeof(marquee)))
+            return -EFAULT;
+        ret = lcd_marquee(&marquee);
+        break;
+    }
+        
+    case LCD_IOC_GLYPH_UNREGISTER:
+        if (arg >= LCD1602_GLYPHS)
+            return -EINVAL;
+        // 다른 fd가 등록한 참조는 반납할 수 없음
+        mutex_lock(&lcd_data->lock);
+        if (!priv->glyph_refs[arg]) {
+            ret = -ENOENT;
+        } else {
+            priv->glyph_refs[arg]--;
+            lcd_glyph_put(arg);
+        }
+        mutex_unlock(&lcd_data->lock);
+        if (!ret)
+            lcd_schedule_flush();
+        break;
+        
+    case LCD_IOC_FLUSH:
+        lcd_schedule_flush();
+        break;
+        
+    case LCD_IOC_SET_REFRESH:
+        if (arg > LCD_REFRESH_MAX_MS)
+            return -EINVAL;
+        mutex_lock(&lcd_data->lock);
+        lcd_data->refresh_ms = arg ? max_t(unsigned long, arg, LCD_REFRESH_MIN_MS) : 0;
+        if (lcd_data->refresh_ms)
+            mod_delayed_work(system_long_wq, &lcd_data->refresh_work,
+                             msecs_to_jiffies(lcd_data->refresh_ms));
         mutex_unlock(&lcd_data->lock);
         break;
         
@@ -327,10 +903,29 @@ static long lcd_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
     return ret;
 }
 
+// 파일 연산 - mmap (frame 페이지를 그대로 노출, copy_from_user 없음)
+static int lcd_mmap(struct file *file, struct vm_area_struct *vma)
+{
+    if (vma->vm_pgoff || vma->vm_end - vma->vm_start > PAGE_SIZE)
+        return -EINVAL;
+    
+    return remap_vmalloc_range(vma, lcd_data->frame, 0);
+}
+
+// 파일 연산 - fsync (LCD_IOC_SYNC와 같은 배리어)
+static int lcd_fsync(struct file *file, loff_t start, loff_t end, int datasync)
+{
+    return lcd_sync();
+}
+
 // 파일 연산 구조체 
 static struct file_operations fops = {
     .owner = THIS_MODULE,
+    .open = lcd_open,
+    .release = lcd_release,
     .write = lcd_write,
+    .fsync = lcd_fsync,
+    .mmap = lcd_mmap,
     .unlocked_ioctl = lcd_ioctl,
 };
 
@@ -340,6 +935,10 @@ static int lcd_i2c_probe(struct i2c_client *client)
     int ret;
     
     lcd_data->client = client;
+    lcd_data->raw_i2c = i2c_check_functionality(client->adapter, I2C_FUNC_I2C);
+    lcd_data->busy_poll = busy_flag;
+    if (client->adapter->quirks)
+        lcd_data->max_write = client->adapter->quirks->max_write_len;
     ret = lcd_init();
     if (ret) {
         pr_err("LCD initialization failed\n");
@@ -353,7 +952,12 @@ static int lcd_i2c_probe(struct i2c_client *client)
 // I2C 드라이버 remove 함수 
 static void lcd_i2c_remove(struct i2c_client *client)
 {
+    cancel_delayed_work_sync(&lcd_data->marquee_work);
+    cancel_delayed_work_sync(&lcd_data->refresh_work);
+    cancel_work_sync(&lcd_data->flush_work);
+    mutex_lock(&lcd_data->io_lock);
     lcd_write_command(LCD_CLEAR_DISPLAY);
+    mutex_unlock(&lcd_data->io_lock);
     pr_info("LCD I2C Driver Removed\n");
 }
 
@@ -381,22 +985,38 @@ static int __init lcd_driver_init(void)
     }
     
     mutex_init(&lcd_data->lock);
+    mutex_init(&lcd_data->io_lock);
+    INIT_WORK(&lcd_data->flush_work, lcd_flush_work);
+    INIT_DELAYED_WORK(&lcd_data->refresh_work, lcd_refresh_work);
+    INIT_DELAYED_WORK(&lcd_data->marquee_work, lcd_marquee_work);
+    
+    // 프레임버퍼 페이지 (사용자 공간 매핑용)
+    BUILD_BUG_ON(LCD1602_FB_SIZE != LCD_MAX_CHARS);
+    lcd_data->frame = vmalloc_user(PAGE_SIZE);
+    if (!lcd_data->frame) {
+        kfree(lcd_data);
+        return -ENOMEM;
+    }
     
     // I2C 어댑터 가져오기
-    adapter = i2c_get_adapter(I2C_BUS_AVAILABLE);
+    adapter = i2c_get_adapter(i2c_bus);
     if (!adapter) {
         pr_err("I2C Adapter not found\n");
+        vfree(lcd_data->frame);
         kfree(lcd_data);
         return -ENODEV;
     }
     
     // I2C 클라이언트 생성
+    lcd_i2c_board_info.addr = i2c_addr;
     lcd_data->client = i2c_new_client_device(adapter, &lcd_i2c_board_info);
     if (IS_ERR(lcd_data->client)) {
         pr_err("Failed to create I2C client\n");
+        ret = PTR_ERR(lcd_data->client);
         i2c_put_adapter(adapter);
+        vfree(lcd_data->frame);
         kfree(lcd_data);
-        return PTR_ERR(lcd_data->client);
+        return ret;
     }
     
     i2c_put_adapter(adapter);
@@ -406,6 +1026,7 @@ static int __init lcd_driver_init(void)
     if (ret < 0) {
         pr_err("Failed to register I2C driver\n");
         i2c_unregister_device(lcd_data->client);
+        vfree(lcd_data->frame);
         kfree(lcd_data);
         return ret;
     }
@@ -415,6 +1036,7 @@ static int __init lcd_driver_init(void)
     if (ret < 0) {
         i2c_del_driver(&lcd_i2c_driver);
         i2c_unregister_device(lcd_data->client);
+        vfree(lcd_data->frame);
         kfree(lcd_data);
         return ret;
     }
@@ -425,6 +1047,7 @@ static int __init lcd_driver_init(void)
         unregister_chrdev_region(first, 1);
         i2c_del_driver(&lcd_i2c_driver);
         i2c_unregister_device(lcd_data->client);
+        vfree(lcd_data->frame);
         kfree(lcd_data);
         return PTR_ERR(cl);
     }
@@ -437,6 +1060,7 @@ static int __init lcd_driver_init(void)
         unregister_chrdev_region(first, 1);
         i2c_del_driver(&lcd_i2c_driver);
         i2c_unregister_device(lcd_data->client);
+        vfree(lcd_data->frame);
         kfree(lcd_data);
         return -1;
     }
@@ -449,6 +1073,7 @@ static int __init lcd_driver_init(void)
         unregister_chrdev_region(first, 1);
         i2c_del_driver(&lcd_i2c_driver);
         i2c_unregister_device(lcd_data->client);
+        vfree(lcd_data->frame);
         kfree(lcd_data);
         return -1;
     }
@@ -469,7 +1094,9 @@ static void __exit lcd_driver_exit(void)
     unregister_chrdev_region(first, 1);
     
     if (lcd_data) {
+        mutex_destroy(&lcd_data->io_lock);
         mutex_destroy(&lcd_data->lock);
+        vfree(lcd_data->frame);
         kfree(lcd_data);
     }
     
@@ -0,0 +1,61 @@
+// drivers/lcd/lcd1602.h
+// /dev/lcd1602 사용자 공간 인터페이스 (드라이버와 애플리케이션이 함께 포함)
+#ifndef LCD1602_H
+#define LCD1602_H
+
+#include <linux/types.h>
+#include <linux/ioctl.h>
+
+// mmap() 프레임버퍼: 한 페이지를 매핑하면 앞 LCD1602_FB_SIZE 바이트가 화면 내용
+// (행 우선: 1행 16칸 다음 2행 16칸, write()가 바꾸는 것과 같은 메모리)
+// 칸에 직접 쓴 뒤 LCD_IOC_FLUSH/LCD_IOC_SYNC를 호출하거나 LCD_IOC_SET_REFRESH로 주기 갱신을 켬
+// 드라이버가 마지막으로 보낸 내용과 비교해서 바뀐 칸만 전송 (매핑하려면 O_RDWR로 열어야 함)
+#define LCD1602_FB_COLS  16
+#define LCD1602_FB_ROWS  2
+#define LCD1602_FB_SIZE  (LCD1602_FB_COLS * LCD1602_FB_ROWS)
+
+// 사용자 정의 글리프 (LCD_IOC_GLYPH_REGISTER)
+// write()와 프레임버퍼에서 handle h는 문자 코드 LCD1602_GLYPH(h)로 씀 (A00 ROM의 빈 영역 0x80~0x9F)
+// 드라이버가 8개 CGRAM 슬롯을 LRU로 관리하며, 화면에 쓰일 때 슬롯에 없는 글리프만 I2C로 올림
+// 한 화면에 9개 이상의 서로 다른 글리프가 있으면 넘치는 칸은 공백으로 표시
+// 참조는 등록한 fd에 속하며 그 fd로만 해제할 수 있고, fd를 닫으면 남은 참조가 모두 반납됨
+// CGRAM 슬롯 코드 0x00~0x0F는 드라이버가 관리하므로 write()에서는 제어 문자(\n \r \f \b) 외에는 무시하고
+// 프레임버퍼에서는 공백으로 표시
+#define LCD1602_GLYPHS       32
+#define LCD1602_GLYPH_BASE   0x80
+#define LCD1602_GLYPH(h)     (LCD1602_GLYPH_BASE + (h))
+
+struct lcd1602_glyph {
+    __u8 rows[8];           // 입력: 위에서 아래로 8행, 각 행의 하위 5비트가 픽셀 (bit 4 = 왼쪽)
+    __u32 handle;           // 출력: 0 ~ LCD1602_GLYPHS-1 (같은 비트맵은 같은 handle, 참조 카운트 증가)
+};
+
+// 마퀴 (LCD_IOC_MARQUEE)
+// 행마다 40칸 DDRAM 전체에 한 번만 쓰고, 드라이버가 step_ms마다 디스플레이 시프트 명령 하나로
+// 화면을 왼쪽으로 한 칸씩 돌림 (40칸 주기로 순환, 하드웨어 특성상 두 행이 함께 움직임)
+// 마퀴가 켜져 있는 동안 write()/프레임버퍼 변경은 보관만 했다가 끌 때 다시 그림
+#define LCD1602_DDRAM_COLS   40
+
+struct lcd1602_marquee {
+    char text[LCD1602_FB_ROWS][LCD1602_DDRAM_COLS];  // 행별 내용 (ASCII, NUL 이후는 공백)
+    __u32 step_ms;          // 한 칸 이동 간격, 0 = 마퀴 끄기
+    __u32 reserved;
+};
+
+// IOCTL 명령어 정의
+#define LCD_IOC_MAGIC  'L'
+#define LCD_IOC_CLEAR       _IO(LCD_IOC_MAGIC, 1)
+#define LCD_IOC_HOME        _IO(LCD_IOC_MAGIC, 2)
+#define LCD_IOC_SETCURSOR   _IOW(LCD_IOC_MAGIC, 3, int[2])  // {col, row}
+#define LCD_IOC_BACKLIGHT   _IOW(LCD_IOC_MAGIC, 4, int)     // 값은 arg로 직접 전달
+#define LCD_IOC_DISPLAY     _IOW(LCD_IOC_MAGIC, 5, int)
+// write()/ioctl은 화면 내용만 바꾸고 바로 반환하며 전송은 커널 작업이 나중에 수행
+// 지금까지의 변경(mmap 포함)이 패널에 반영될 때까지 대기 (fsync()와 같음, 그 사이 전송 오류를 반환)
+#define LCD_IOC_SYNC        _IO(LCD_IOC_MAGIC, 6)
+#define LCD_IOC_FLUSH       _IO(LCD_IOC_MAGIC, 7)           // 프레임버퍼 전송 예약 (기다리지 않음)
+#define LCD_IOC_SET_REFRESH _IO(LCD_IOC_MAGIC, 8)           // 주기 갱신 ms (0 = 끔, 최대 60000), 값은 arg로 직접 전달
+#define LCD_IOC_GLYPH_REGISTER    _IOWR(LCD_IOC_MAGIC, 9, struct lcd1602_glyph)  // 가득 차면 -ENOSPC
+#define LCD_IOC_GLYPH_UNREGISTER  _IO(LCD_IOC_MAGIC, 10)         // handle은 arg로 직접 전달
+#define LCD_IOC_MARQUEE     _IOW(LCD_IOC_MAGIC, 11, struct lcd1602_marquee)
+
+#endif // LCD1602_H
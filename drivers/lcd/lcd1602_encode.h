@@ -0,0 +1,57 @@
+// drivers/lcd/lcd1602_encode.h
+// HD44780 4비트 모드 → PCF8574 I2C 바이트 인코딩 (커널 모듈과 호스트 테스트/벤치마크가 함께 포함)
+// 커널/libc 헤더에 의존하지 않는 순수 C
+#ifndef LCD1602_ENCODE_H
+#define LCD1602_ENCODE_H
+
+// PCF8574 핀 매핑 (P7~P4: D7~D4)
+#define LCD1602_BACKLIGHT  0x08
+#define LCD1602_ENABLE     0x04
+#define LCD1602_RW         0x02
+#define LCD1602_RS         0x01
+
+#define LCD1602_NIBBLE_BYTES  3    // 설정, EN high, EN low
+#define LCD1602_BYTE_BYTES    (2 * LCD1602_NIBBLE_BYTES)
+
+// 패널로 보낼 명령/데이터 바이트 하나 (control: 0 = 명령, LCD1602_RS = 데이터)
+struct lcd1602_op {
+    unsigned char value;
+    unsigned char control;
+};
+
+// 상위 니블(data & 0xF0) 하나를 EN 펄스 포함 3바이트로 인코딩
+// control: 0 (명령) 또는 LCD1602_RS (데이터)
+static inline unsigned int lcd1602_encode_nibble(unsigned char *out, unsigned char data,
+                                                 unsigned char control, int backlight)
+{
+    unsigned char value = (data & 0xF0) | control | (backlight ? LCD1602_BACKLIGHT : 0);
+
+    out[0] = value;
+    out[1] = value | LCD1602_ENABLE;
+    out[2] = value;
+    return LCD1602_NIBBLE_BYTES;
+}
+
+// 명령/데이터 한 바이트를 상위 → 하위 니블 순서로 6바이트 인코딩
+static inline unsigned int lcd1602_encode_byte(unsigned char *out, unsigned char value,
+                                               unsigned char control, int backlight)
+{
+    lcd1602_encode_nibble(out, value, control, backlight);
+    lcd1602_encode_nibble(out + LCD1602_NIBBLE_BYTES, value << 4, control, backlight);
+    return LCD1602_BYTE_BYTES;
+}
+
+// 명령/데이터 배열을 하나의 I2C 쓰기로 보낼 수 있도록 연속 인코딩 (ops 하나당 6바이트)
+// 바이트 사이 간격이 버스 속도로 정해지므로, 100~400kHz에서는 EN 펄스 폭(450ns)과
+// 명령 실행 시간(37μs)이 별도 지연 없이 확보됨 (CLEAR/HOME 같은 느린 명령 뒤에서는 끊어야 함)
+static inline unsigned int lcd1602_encode_ops(unsigned char *out, const struct lcd1602_op *ops,
+                                              unsigned int n, int backlight)
+{
+    unsigned int i, len = 0;
+
+    for (i = 0; i < n; i++)
+        len += lcd1602_encode_byte(out + len, ops[i].value, ops[i].control, backlight);
+    return len;
+}
+
+#endif // LCD1602_ENCODE_H
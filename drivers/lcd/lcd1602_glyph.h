@@ -0,0 +1,70 @@
+// drivers/lcd/lcd1602_glyph.h
+// CGRAM 사용자 정의 글리프 슬롯 관리 (커널 모듈과 호스트 테스트가 함께 포함)
+// 커널/libc 헤더에 의존하지 않는 순수 C
+#ifndef LCD1602_GLYPH_H
+#define LCD1602_GLYPH_H
+
+#define LCD1602_CGRAM_SLOTS   8     // 5x8 글리프 슬롯 수 (문자 코드 0~7)
+#define LCD1602_GLYPH_ROWS    8
+
+#define LCD1602_CMD_SET_CGRAM_ADDR  0x40
+
+// 슬롯 하나를 올리는 데 필요한 명령/데이터 수 (CGRAM 주소 + 8행)
+#define LCD1602_GLYPH_LOAD_OPS  (1 + LCD1602_GLYPH_ROWS)
+
+// 패널 CGRAM 상태
+// key는 등록마다 새로 발급되는 0이 아닌 값이라, 해제 후 같은 handle이 재사용되어도
+// 예전 비트맵이 남은 슬롯과 섞이지 않고 LRU로 밀려남
+struct lcd1602_cgram {
+    unsigned int key[LCD1602_CGRAM_SLOTS];        // 슬롯에 올라간 글리프, 0 = 빈 슬롯
+    unsigned int last_used[LCD1602_CGRAM_SLOTS];  // 마지막으로 화면에 쓰인 tick
+};
+
+// 패널 상태를 알 수 없을 때 (초기화, 전송 실패) 모든 슬롯을 비움
+static inline void lcd1602_cgram_reset(struct lcd1602_cgram *cgram)
+{
+    unsigned int i;
+
+    for (i = 0; i < LCD1602_CGRAM_SLOTS; i++) {
+        cgram->key[i] = 0;
+        cgram->last_used[i] = 0;
+    }
+}
+
+// key 글리프를 담을 슬롯 선택
+// 이미 올라가 있으면 그 슬롯, 아니면 빈 슬롯, 없으면 pinned(이번 화면이 쓰는 슬롯 비트마스크)가
+// 아닌 슬롯 중 가장 오래 안 쓰인 슬롯을 고르고 *load = 1 (비트맵을 올려야 함)
+// 반환 -1: 이번 화면이 8개 슬롯을 모두 쓰고 있음
+static inline int lcd1602_cgram_slot(struct lcd1602_cgram *cgram, unsigned int key,
+                                     unsigned int pinned, unsigned int tick, int *load)
+{
+    int i, victim = -1;
+
+    *load = 0;
+    for (i = 0; i < LCD1602_CGRAM_SLOTS; i++) {
+        if (cgram->key[i] == key) {
+            cgram->last_used[i] = tick;
+            return i;
+        }
+    }
+
+    for (i = 0; i < LCD1602_CGRAM_SLOTS; i++) {
+        if (pinned & (1u << i))
+            continue;
+        if (!cgram->key[i]) {
+            victim = i;
+            break;
+        }
+        if (victim < 0 || cgram->last_used[i] < cgram->last_used[victim])
+            victim = i;
+    }
+    if (victim < 0)
+        return -1;
+
+    cgram->key[victim] = key;
+    cgram->last_used[victim] = tick;
+    *load = 1;
+    return victim;
+}
+
+#endif // LCD1602_GLYPH_H
@@ -0,0 +1,53 @@
+// drivers/lcd/lcd1602_shadow.h
+// 16x2 DDRAM 섀도 버퍼 비교 (커널 모듈과 호스트 테스트가 함께 포함)
+// 커널/libc 헤더에 의존하지 않는 순수 C
+#ifndef LCD1602_SHADOW_H
+#define LCD1602_SHADOW_H
+
+#include "lcd1602_encode.h"
+
+#define LCD1602_COLS   16
+#define LCD1602_ROWS   2
+#define LCD1602_CELLS  (LCD1602_COLS * LCD1602_ROWS)
+
+#define LCD1602_CMD_SET_DDRAM_ADDR  0x80
+
+// 칸마다 주소 명령 + 문자가 최악의 경우
+#define LCD1602_DIFF_MAX_OPS  (2 * LCD1602_CELLS)
+
+// 칸 번호(row * COLS + col)의 DDRAM 주소 (1행 0x00~, 2행 0x40~)
+static inline int lcd1602_cell_addr(unsigned int cell)
+{
+    return (cell / LCD1602_COLS) * 0x40 + cell % LCD1602_COLS;
+}
+
+// shadow(패널에 있는 내용)와 frame(원하는 내용)을 비교해 바뀐 칸만 쓰는 순서를 ops에 기록
+// *ac: 패널 주소 카운터 (모르면 -1), 반환 시 마지막으로 쓴 칸의 다음 주소
+// full이 0이 아니면 shadow를 믿지 않고 모든 칸을 씀
+// 주소 명령과 문자 한 칸의 전송 비용이 같으므로, 주소 카운터가 이미 그 칸에 있을 때만
+// 주소 명령을 생략하는 것이 최소 (깨끗한 칸을 다시 쓰는 쪽이 더 싼 경우는 없음)
+// 행 끝(0x0F) 다음 주소는 0x10이라 다음 행으로 넘어갈 때는 항상 주소 명령이 들어감
+static inline unsigned int lcd1602_diff(struct lcd1602_op *ops, const unsigned char *shadow,
+                                        const unsigned char *frame, int full, int *ac)
+{
+    unsigned int cell, n = 0;
+    int addr;
+
+    for (cell = 0; cell < LCD1602_CELLS; cell++) {
+        if (!full && shadow[cell] == frame[cell])
+            continue;
+
+        addr = lcd1602_cell_addr(cell);
+        if (*ac != addr) {
+            ops[n].value = LCD1602_CMD_SET_DDRAM_ADDR | addr;
+            ops[n++].control = 0;
+        }
+        ops[n].value = frame[cell];
+        ops[n++].control = LCD1602_RS;
+        *ac = addr + 1;
+    }
+
+    return n;
+}
+
+#endif // LCD1602_SHADOW_H
@@ -0,0 +1,89 @@
+// drivers/ultrasonic/hc_sr04p.h
+// /dev/hc_sr04p 사용자 공간 인터페이스 (드라이버와 애플리케이션이 함께 포함)
+#ifndef HC_SR04P_H
+#define HC_SR04P_H
+
+#include <linux/types.h>
+#include <linux/ioctl.h>
+
+// 읽기 형식
+#define HC_SR04P_FMT_TEXT    0  // "거리\n" (연속 측정 모드: "타임스탬프 거리\n")
+#define HC_SR04P_FMT_BINARY  1  // struct hc_sr04p_sample 배열
+#define HC_SR04P_FMT_EVENTS  2  // struct hc_sr04p_event 배열 (재실 상태 변화만)
+
+// 측정 상태 코드
+#define HC_SR04P_STATUS_OK            0
+#define HC_SR04P_STATUS_OUT_OF_RANGE  1  // 펄스 폭이 20μs ~ 38ms 범위 밖
+#define HC_SR04P_STATUS_NO_ECHO       2  // 제한 시간 안에 rising edge가 오지 않음
+#define HC_SR04P_STATUS_REJECTED      3  // 필터가 이상치로 판단해 버림
+#define HC_SR04P_STATUS_ECHO_STUCK    4  // rising edge 후 제한 시간 안에 falling edge가 오지 않음
+
+// 바이너리 모드 측정 레코드 (32바이트 고정 크기)
+struct hc_sr04p_sample {
+    __s64 pulse_start_ns;   // ECHO rising edge (CLOCK_MONOTONIC)
+    __s64 pulse_end_ns;     // ECHO falling edge, 에코가 없으면 타임아웃 시각
+    __s32 distance_mm;      // 필터 적용 후 거리, 오류 시 -1
+    __u32 status;           // HC_SR04P_STATUS_*
+    __u32 seq;              // 측정 순번 (빠진 번호 = 유실된 샘플)
+    __s32 raw_mm;           // 필터 적용 전 거리, 오류 시 -1
+};
+
+// mmap() 링 버퍼 헤더 (매핑의 첫 페이지)
+// 커널이 유일한 생산자: 레코드를 쓴 뒤 head를 증가 (release)
+// 사용자 공간이 유일한 소비자: head를 읽고 (acquire) [tail, head) 레코드를 처리한 뒤 tail을 갱신 (release)
+// head/tail은 계속 증가하는 값이며 레코드 위치는 (index & (entries - 1))
+// 링이 비어 있다가 레코드가 들어오면 poll()이 EPOLLIN을 알림 (레코드마다 깨우지 않음)
+// head/overruns는 커널이 가진 값의 복사본이라 사용자 공간이 써도 다음 레코드에서 덮어씀
+struct hc_sr04p_ring {
+    __u32 head;         // 커널 쓰기 위치
+    __u32 entries;      // 레코드 수 (2의 거듭제곱)
+    __u32 data_offset;  // 매핑 시작점부터 레코드 배열까지의 바이트 수
+    __u32 overruns;     // 링이 가득 차서 버린 레코드 수
+    __u32 reserved0[12];
+    __u32 tail;         // 사용자 공간 읽기 위치 (캐시 라인 분리)
+    __u32 reserved1[15];
+};
+
+// 재실 상태
+#define HC_SR04P_PRESENCE_ABSENT   0
+#define HC_SR04P_PRESENCE_PRESENT  1
+
+// 재실 상태 변화 이벤트 (16바이트 고정 크기)
+struct hc_sr04p_event {
+    __s64 timestamp_ns;     // 상태를 바꾼 샘플의 측정 시각 (CLOCK_MONOTONIC)
+    __u32 state;            // HC_SR04P_PRESENCE_*
+    __s32 distance_mm;      // 상태를 바꾼 샘플의 거리, 에코 없음이면 -1
+};
+
+// 재실 판정 설정 (HC_SR04P_IOC_SET_PRESENCE)
+// 파일별이 아닌 센서 전체 설정이며 이벤트 큐도 그 센서를 연 모든 fd가 공유 (먼저 읽은 쪽이 가져감)
+// 판정은 발행되는 샘플마다 하므로, 읽기 시 측정 모드(sample_hz=0)에서는 누군가 읽어서 측정할 때만 진행되고
+// 문 감시처럼 이벤트만 기다리려면 연속 측정 모드(sample_hz > 0)로 로드해야 함
+// distance <= near_mm 샘플이 count번 연속이면 PRESENT,
+// distance > far_mm (또는 에코 없음) 샘플이 count번 연속이고 마지막 near 샘플 후 hold_ms가 지나면 ABSENT
+struct hc_sr04p_presence {
+    __s32 near_mm;          // 0/0 = 재실 판정 끄기
+    __s32 far_mm;
+    __u32 count;            // 연속 샘플 수 (0은 1로 취급)
+    __u32 hold_ms;          // PRESENT 유지 시간
+};
+
+// HC_SR04P_IOC_GET_LATEST 인자
+struct hc_sr04p_latest {
+    __u32 max_age_ms;               // 입력: 허용하는 샘플 나이 (측정 완료 시각 기준)
+    __u32 reserved;
+    struct hc_sr04p_sample sample;  // 출력
+};
+
+// IOCTL 명령어 정의
+#define HC_SR04P_IOC_MAGIC  'U'
+// 연속 측정 모드에서 distance <= near_mm / distance > far_mm 구간이 바뀔 때만 샘플 전달
+// 파일별이 아닌 센서 전체 설정 (그 센서를 연 모든 fd에 적용), CAP_SYS_ADMIN 필요
+#define HC_SR04P_IOC_SET_THRESHOLD  _IOW(HC_SR04P_IOC_MAGIC, 1, int[2])  // {near_mm, far_mm}, 0/0 = 해제
+#define HC_SR04P_IOC_SET_FORMAT     _IO(HC_SR04P_IOC_MAGIC, 2)           // HC_SR04P_FMT_*, 값은 arg로 직접 전달 (포인터 아님)
+// 최근 샘플이 max_age_ms 이내면 바로 반환, 아니면 진행 중인 측정에 합류하거나 새로 측정해서 반환
+// (O_NONBLOCK이면 측정만 예약하고 -EAGAIN, 연속 측정 모드에서는 -ENODATA)
+#define HC_SR04P_IOC_GET_LATEST     _IOWR(HC_SR04P_IOC_MAGIC, 3, struct hc_sr04p_latest)
+#define HC_SR04P_IOC_SET_PRESENCE   _IOW(HC_SR04P_IOC_MAGIC, 4, struct hc_sr04p_presence)  // CAP_SYS_ADMIN 필요
+
+#endif // HC_SR04P_H
@@ -0,0 +1,24 @@
+// drivers/ultrasonic/hc_sr04p_conv.h
+// 에코 펄스 폭 → 거리 변환 (커널 모듈과 호스트 테스트/벤치마크가 함께 포함)
+// 커널/libc 헤더에 의존하지 않는 순수 C
+#ifndef HC_SR04P_CONV_H
+#define HC_SR04P_CONV_H
+
+#define HC_SR04P_PULSE_MIN_US  20      // 약 3mm
+#define HC_SR04P_PULSE_MAX_US  38000   // 약 6.5m (이보다 길면 에코 없음)
+
+// 펄스 폭(ns) → 거리(mm), 유효 범위(20μs ~ 38ms) 밖이면 -1
+// 범위를 먼저 확인해서 32비트 나눗셈만 사용 (32비트 ARM에서 64비트 나눗셈 호출 없음)
+static inline int hc_sr04p_pulse_to_mm(long long pulse_ns)
+{
+    unsigned int us;
+
+    if (pulse_ns < HC_SR04P_PULSE_MIN_US * 1000LL ||
+        pulse_ns >= (HC_SR04P_PULSE_MAX_US + 1) * 1000LL)
+        return -1;
+
+    us = (unsigned int)pulse_ns / 1000;
+    return (int)(us * 10 / 58);    // 왕복 음속 기준 1mm = 5.8μs
+}
+
+#endif // HC_SR04P_CONV_H
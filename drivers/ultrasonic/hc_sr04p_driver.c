@@ -13,42 +13,282 @@
 #include <linux/mutex.h>
 #include <linux/wait.h>
 #include <linux/atomic.h>
+#include <linux/hrtimer.h>
+#include <linux/kfifo.h>
+#include <linux/spinlock.h>
+#include <linux/poll.h>
+#include <linux/ioctl.h>
+#include <linux/slab.h>
+#include <linux/mm.h>
+#include <linux/vmalloc.h>
+#include <linux/sysfs.h>
+#include <linux/math64.h>
+#include <linux/seqlock.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/bitops.h>
+#include <linux/capability.h>
+#include <linux/workqueue.h>
+#if IS_ENABLED(CONFIG_IIO_TRIGGERED_BUFFER)
+#include <linux/iio/iio.h>
+#include <linux/iio/buffer.h>
+#include <linux/iio/trigger_consumer.h>
+#include <linux/iio/triggered_buffer.h>
+#endif
+
+#include "hc_sr04p.h"
+#include "hc_sr04p_conv.h"
+
+#define CREATE_TRACE_POINTS
+#include "hc_sr04p_trace.h"
 
 #define DEVICE_NAME "hc_sr04p"
 #define CLASS_NAME "ultrasonic"
 
-// GPIO 핀 설정 (라즈베리파이 기준)
+// GPIO 핀 설정 (라즈베리파이 기준, 첫 번째 센서 기본값)
 #define TRIGGER_PIN 523
 #define ECHO_PIN 525
+#define MAX_SENSORS 4
+
+// 연속 측정 모드 설정
+#define SAMPLE_HZ_MAX 16        // 60ms 최소 간격 (센서 스펙)
+#define SAMPLE_FIFO_SIZE 64     // 2의 거듭제곱 (15Hz 기준 약 4초 분량)
+#define SAMPLE_RING_ENTRIES 256 // mmap 링 레코드 수 (2의 거듭제곱)
+#define EVENT_FIFO_SIZE 16      // 재실 이벤트 큐 (2의 거듭제곱)
+#define PRESENCE_HOLD_MAX_MS 60000
+
+#define TRIGGER_PULSE_US 15     // 10μs 이상
+#define MIN_INTERVAL_MS 60      // 같은 센서의 트리거 최소 간격 (센서 스펙)
+#define ECHO_DEADLINE_MS 45     // 트리거부터 에코 완료까지 제한 (최대 펄스 38ms + 여유)
+#define MAX_AGE_NEXT_TRIGGER (-1)   // sensor_get_sample(): 다음 트리거가 가능해질 때까지만 재사용
+
+// 거리 필터 설정 한계
+#define FILTER_MEDIAN_MAX 7         // 중앙값 창 크기 (홀수)
+#define FILTER_EMA_SHIFT_MAX 6      // EMA 계수 1/2^shift
+#define FILTER_OUTLIER_MAX_RUN 3    // 연속으로 이만큼 벗어나면 실제 변화로 보고 수용
+#define FILTER_THRESHOLD_MAX 6600   // 측정 가능 최대 거리 (mm)
+
+// debugfs 통계
+#define HIST_BUCKETS 32             // log2 구간 (마지막 구간은 2^30ns 이상 전부)
+
+static unsigned int sample_hz;
+module_param(sample_hz, uint, 0444);
+MODULE_PARM_DESC(sample_hz, "Free-running sample rate per sensor in Hz (0 = measure on read, max 16)");
+
+// 센서별 트리거/에코 핀 (순서대로 짝을 이룸, 센서마다 /dev/hc_sr04p, /dev/hc_sr04p1, ...)
+static int trigger_pins[MAX_SENSORS] = { TRIGGER_PIN };
+static unsigned int num_trigger_pins = 1;
+module_param_array(trigger_pins, int, &num_trigger_pins, 0444);
+MODULE_PARM_DESC(trigger_pins, "Trigger GPIO of each sensor");
+
+static int echo_pins[MAX_SENSORS] = { ECHO_PIN };
+static unsigned int num_echo_pins = 1;
+module_param_array(echo_pins, int, &num_echo_pins, 0444);
+MODULE_PARM_DESC(echo_pins, "Echo GPIO of each sensor");
+
+static unsigned int stagger_ms = 40;
+module_param(stagger_ms, uint, 0444);
+MODULE_PARM_DESC(stagger_ms, "Minimum spacing between triggers of different sensors in ms (crosstalk guard)");
+
+// 측정 상태 (IDLE → TRIGGERED → ECHO_HIGH → DONE/TIMEOUT), atomic_cmpxchg로만 전이
+enum sensor_state {
+    SENSOR_IDLE,        // 측정 이력 없음
+    SENSOR_TRIGGERED,   // 트리거 펄스 출력, rising edge 대기
+    SENSOR_ECHO_HIGH,   // 에코 펄스 측정 중
+    SENSOR_DONE,        // 결과 발행 완료
+    SENSOR_TIMEOUT      // 에코 없음
+};
+
+// 거리 필터 체인 (정수 연산만 사용): 이상치 제거 → 스파이크 억제 → 중앙값 → EMA
+struct sensor_filter {
+    // 설정 (sysfs, 0 = 사용 안 함)
+    unsigned int median;        // 중앙값 창 크기
+    unsigned int ema_shift;     // EMA 계수 1/2^shift
+    unsigned int outlier_mm;    // 직전 값과 이보다 차이 나면 버림
+    unsigned int spike_mm;      // 직전 값과 이보다 차이 나는 단발성 샘플은 직전 값으로 대체
+    
+    // 상태
+    bool have_prev;
+    int prev_mm;
+    unsigned int outlier_run;
+    bool spike_held;
+    int window[FILTER_MEDIAN_MAX];
+    unsigned int window_pos;
+    unsigned int window_count;
+    bool ema_valid;
+    int ema_q8;                 // Q24.8 고정소수점
+};
+
+// 재실 판정 상태 머신 (sample_lock으로 보호)
+struct sensor_presence {
+    struct hc_sr04p_presence cfg;   // far_mm == 0이면 꺼짐
+    u32 state;                      // HC_SR04P_PRESENCE_*
+    unsigned int run;               // 상태를 바꾸는 쪽 샘플의 연속 횟수
+    s64 last_near_ns;               // 마지막 near 샘플 시각 (hold 기준)
+};
+
+// debugfs 카운터 (atomic이라 IRQ/타이머/읽기 경로 어디서든 락 없이 증가)
+enum sensor_stat {
+    STAT_TRIGGERS,
+    STAT_VALID,
+    STAT_OUT_OF_RANGE,
+    STAT_REJECTED,
+    STAT_TIMEOUTS,
+    STAT_SCHED_RETRIES,     // 최소 간격/측정 중이라 스케줄러가 트리거를 미룬 횟수 (읽기 오류 아님)
+    STAT_ERESTARTSYS,
+    STAT_COUNT
+};
+
+static const char * const stat_names[STAT_COUNT] = {
+    [STAT_TRIGGERS] = "triggers",
+    [STAT_VALID] = "valid_echoes",
+    [STAT_OUT_OF_RANGE] = "out_of_range",
+    [STAT_REJECTED] = "filter_rejected",
+    [STAT_TIMEOUTS] = "timeouts",
+    [STAT_SCHED_RETRIES] = "sched_retries",
+    [STAT_ERESTARTSYS] = "erestartsys",
+};
+
+// debugfs 지연 히스토그램 (ns, log2 구간)
+enum sensor_hist {
+    HIST_ECHO_WIDTH,        // 에코 펄스 폭
+    HIST_TRIGGER_RISING,    // 트리거 → rising edge
+    HIST_IRQ_HANDLER,       // falling edge IRQ → 스레드 처리 완료
+    HIST_READ_LATENCY,      // device_read() 진입 → 반환
+    HIST_COUNT
+};
+
+static const char * const hist_names[HIST_COUNT] = {
+    [HIST_ECHO_WIDTH] = "echo_width_ns",
+    [HIST_TRIGGER_RISING] = "trigger_to_rising_ns",
+    [HIST_IRQ_HANDLER] = "irq_handler_ns",
+    [HIST_READ_LATENCY] = "read_latency_ns",
+};
+
+struct sensor_stats {
+    atomic_long_t counters[STAT_COUNT];
+    atomic_long_t hist[HIST_COUNT][HIST_BUCKETS];
+};
 
 // 디바이스 데이터 구조
 struct sensor_data {
     dev_t dev_number;
-    struct class *dev_class;
     struct device *dev_device;
     struct cdev char_dev;
     
+    // 센서 식별
+    unsigned int index;
+    int trigger_pin;
+    int echo_pin;
+    char name[16];
+    char irq_name[24];
+    
     // 센서 관련
     ktime_t pulse_start;
     ktime_t pulse_end;
+    ktime_t edge_time;      // 상반부가 기록한 falling edge 시각
     int distance_mm;
+    int raw_mm;             // 필터 적용 전 거리
     int irq_number;
     
+    // IRQ 상반부 타임스탬프 → 스레드 핸들러 실행까지의 지연 (sysfs로 노출)
+    s64 irq_skew_last_ns;
+    s64 irq_skew_max_ns;
+    s64 irq_skew_total_ns;
+    u64 irq_skew_count;
+    
     // 동기화
     wait_queue_head_t wait_queue;
-    atomic_t measurement_ready;
     struct mutex lock;
     
     // 상태 관리
+    atomic_t state;     // enum sensor_state
+    struct hrtimer trigger_timer;
+    struct hrtimer deadline_timer;  // 에코 유실 감시
+    
+    // 트리거 핀이 슬립할 수 있는 GPIO 칩(I2C 확장기, gpio-sim 등)에 있으면
+    // 락/hrtimer 안에서 핀을 바꿀 수 없으므로 펄스 전체를 워크에서 생성
+    bool trigger_cansleep;
+    struct work_struct trigger_work;
+    
+    ktime_t last_trigger;
+    
+    // 스케줄러 요청 (sched.lock으로 보호)
+    bool trigger_pending;   // 읽기 요청으로 측정 대기 중
+    ktime_t next_due;       // 연속 측정 모드의 다음 트리거 예정 시각
+    
+    // 연속 측정 모드
+    spinlock_t sample_lock;
+    DECLARE_KFIFO(samples, struct hc_sr04p_sample, SAMPLE_FIFO_SIZE);
+    unsigned int samples_dropped;
+    
+    // 마지막 측정 결과 (바이너리 레코드)
+    // 쓰기는 sample_lock 보유 상태에서, 읽기는 락 없이 sensor_snapshot()으로
+    seqcount_spinlock_t last_seqcount;
+    struct hc_sr04p_sample last;
+    u32 seq;    // 다음에 발행할 순번 (증가 = 새 결과, 읽기 대기자는 이 값의 변화를 기다림)
+    
+    // mmap 링 버퍼 (헤더 페이지 + 레코드 배열)
+    // 헤더 페이지는 사용자 공간이 쓸 수 있으므로 head/overruns의 원본은 여기 두고 복사본만 게시
+    struct hc_sr04p_ring *ring;
+    struct hc_sr04p_sample *ring_data;
+    size_t ring_size;
+    u32 ring_head;              // sample_lock으로 보호, poll은 READ_ONCE
+    u32 ring_overruns;
+    wait_queue_head_t ring_wait;    // mmap 소비자 전용 (링이 비어 있다가 채워질 때만 깨움)
+    
+    // 거리 필터 (sample_lock으로 보호)
+    struct sensor_filter filter;
+    
+    // debugfs 통계
+    struct sensor_stats stats;
+    struct dentry *debug_dir;
+    
+    // IIO 디바이스 (커널에 IIO triggered buffer가 없거나 등록에 실패하면 NULL)
+    struct iio_dev *indio_dev;
+    
+    // 거리 임계값 (연속 측정 모드에서 구간이 바뀔 때만 샘플 전달)
+    // 샘플 FIFO가 센서 하나에 하나라서 파일별이 아닌 센서 전체 설정
+    int near_mm;
+    int far_mm;
     enum {
-        SENSOR_IDLE,
-        SENSOR_MEASURING
-    } state;
+        ZONE_UNKNOWN,
+        ZONE_NEAR,
+        ZONE_FAR
+    } zone;
     
-    unsigned long last_trigger_time;
+    // 재실 판정 (상태 변화 이벤트는 HC_SR04P_FMT_EVENTS로 읽음)
+    struct sensor_presence presence;
+    DECLARE_KFIFO(events, struct hc_sr04p_event, EVENT_FIFO_SIZE);
+    unsigned int events_dropped;
 };
 
-static struct sensor_data *sensor_dev;
+static struct class *sensor_class;
+static dev_t sensor_devt;
+static struct sensor_data *sensors[MAX_SENSORS];
+static unsigned int num_sensors;
+static struct dentry *debug_root;
+
+// 트리거 스케줄러: 한 번에 한 센서만 측정해서 센서 간 에코 간섭을 막고,
+// 조건이 풀리는 즉시 다음 센서를 트리거해서 전체 샘플 수를 최대로 유지
+static struct {
+    spinlock_t lock;
+    struct hrtimer timer;
+    struct sensor_data *active;     // 에코를 기다리는 센서
+    unsigned int next;              // 라운드 로빈 시작 위치
+    ktime_t last_trigger;           // 센서와 무관한 마지막 트리거 시각
+    ktime_t period;                 // 연속 측정 주기 (센서별)
+    bool stopping;
+} sched;
+
+// 파일별 상태 (open 시 할당)
+struct sensor_file {
+    struct sensor_data *sensor;
+    int format;     // HC_SR04P_FMT_*
+    bool mapped;    // mmap 링 소비자 (poll은 링 상태를 봄)
+    bool waiting;   // 논블로킹 읽기로 측정 결과를 기다리는 중
+    u32 wait_seq;   // 기다리기 시작할 때의 sensor_data.seq
+};
 
 // *** 추가: 디바이스 권한 자동 설정 함수 ***
 static int hc_sr04p_dev_uevent(const struct device *dev, struct kobj_uevent_env *env)
@@ -57,112 +297,779 @@ static int hc_sr04p_dev_uevent(const struct device *dev, struct kobj_uevent_env
     return 0;
 }
 
-// 인터럽트 핸들러 (ECHO 핀의 rising/falling edge)
+// 임계값 구간 판정: 구간이 바뀌었으면 true (near~far 사이는 이전 구간 유지)
+static bool zone_changed(struct sensor_data *data, int distance_mm) {
+    int zone = data->zone;
+    
+    if (distance_mm < 0)
+        return false;
+    
+    // 재실 판정(presence_update)과 같은 경계: near_mm 이하가 NEAR
+    if (distance_mm <= data->near_mm)
+        zone = ZONE_NEAR;
+    else if (distance_mm > data->far_mm)
+        zone = ZONE_FAR;
+    
+    if (zone == data->zone)
+        return false;
+    
+    data->zone = zone;
+    return true;
+}
+
+// 통계 카운터 증가
+static void stat_inc(struct sensor_data *data, enum sensor_stat stat) {
+    atomic_long_inc(&data->stats.counters[stat]);
+}
+
+// 히스토그램에 값 기록: 구간 b는 [2^(b-1), 2^b) (0은 구간 0)
+static void hist_add(struct sensor_data *data, enum sensor_hist hist, s64 ns) {
+    unsigned int bucket = ns > 0 ? min_t(unsigned int, fls64(ns), HIST_BUCKETS - 1) : 0;
+    
+    atomic_long_inc(&data->stats.hist[hist][bucket]);
+}
+
+// 필터 상태 초기화 (설정 변경 시)
+static void filter_reset(struct sensor_filter *f) {
+    f->have_prev = false;
+    f->outlier_run = 0;
+    f->spike_held = false;
+    f->window_pos = 0;
+    f->window_count = 0;
+    f->ema_valid = false;
+}
+
+// 중앙값 창에서 중앙값 계산 (창이 작으므로 삽입 정렬)
+static int filter_median(struct sensor_filter *f, int mm) {
+    int sorted[FILTER_MEDIAN_MAX];
+    unsigned int i, j;
+    int v;
+    
+    f->window[f->window_pos] = mm;
+    f->window_pos = (f->window_pos + 1) % f->median;
+    if (f->window_count < f->median)
+        f->window_count++;
+    
+    for (i = 0; i < f->window_count; i++) {
+        v = f->window[i];
+        for (j = i; j > 0 && sorted[j - 1] > v; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = v;
+    }
+    
+    return sorted[f->window_count / 2];
+}
+
+// 필터 체인 적용 (sample_lock 보유 상태에서 호출)
+// 반환값: 필터 출력 거리, 이상치로 버려야 하면 -1
+static int filter_apply(struct sensor_filter *f, int mm) {
+    int diff = f->have_prev ? abs(mm - f->prev_mm) : 0;
+    
+    // 이상치 제거: 직전 값에서 크게 벗어난 샘플은 버리되, 계속 벗어나면 새 기준으로 수용
+    if (f->outlier_mm && diff > f->outlier_mm) {
+        if (++f->outlier_run <= FILTER_OUTLIER_MAX_RUN)
+            return -1;
+        filter_reset(f);
+        diff = 0;
+    }
+    f->outlier_run = 0;
+    
+    // 스파이크 억제: 튄 샘플 하나는 직전 값으로 대체, 다음 샘플도 튀면 실제 변화로 수용
+    if (f->spike_mm && diff > f->spike_mm && !f->spike_held) {
+        f->spike_held = true;
+        mm = f->prev_mm;
+    } else {
+        f->spike_held = false;
+    }
+    
+    f->have_prev = true;
+    f->prev_mm = mm;
+    
+    if (f->median > 1)
+        mm = filter_median(f, mm);
+    
+    if (f->ema_shift) {
+        if (!f->ema_valid) {
+            f->ema_q8 = mm << 8;
+            f->ema_valid = true;
+        } else {
+            f->ema_q8 += ((mm << 8) - f->ema_q8) >> f->ema_shift;
+        }
+        mm = (f->ema_q8 + 128) >> 8;
+    }
+    
+    return mm;
+}
+
+// mmap 링 헤더의 tail (사용자 공간이 쓰는 값이므로 범위를 검증해서 사용)
+static u32 ring_tail(struct sensor_data *data, u32 head) {
+    u32 tail = smp_load_acquire(&data->ring->tail);
+    
+    if (head - tail > SAMPLE_RING_ENTRIES)
+        tail = head - SAMPLE_RING_ENTRIES;
+    
+    return tail;
+}
+
+// mmap 링에 레코드 적재 (단일 생산자, sample_lock 보유 상태에서 호출)
+// 링이 비어 있다가 채워졌으면 mmap 소비자를 깨움
+static void ring_push(struct sensor_data *data, const struct hc_sr04p_sample *sample) {
+    struct hc_sr04p_ring *ring = data->ring;
+    u32 head = data->ring_head;
+    u32 tail = ring_tail(data, head);
+    
+    if (head - tail == SAMPLE_RING_ENTRIES) {
+        data->ring_overruns++;
+        WRITE_ONCE(ring->overruns, data->ring_overruns);
+        return;
+    }
+    
+    data->ring_data[head & (SAMPLE_RING_ENTRIES - 1)] = *sample;
+    WRITE_ONCE(data->ring_head, head + 1);
+    smp_store_release(&ring->head, head + 1);
+    
+    if (head == tail)
+        wake_up_interruptible(&data->ring_wait);
+}
+
+// 재실 상태 머신에 샘플 반영 (sample_lock 보유 상태에서 호출)
+// 반환값: 상태가 바뀌어 이벤트를 적재했으면 true
+static bool presence_update(struct sensor_data *data, const struct hc_sr04p_sample *sample) {
+    struct sensor_presence *p = &data->presence;
+    struct hc_sr04p_event event;
+    unsigned int count = max(p->cfg.count, 1U);
+    bool ok = sample->status == HC_SR04P_STATUS_OK;
+    bool near, far;
+    
+    // 필터가 버린 샘플은 판단에 쓰지 않음
+    if (!p->cfg.far_mm || sample->status == HC_SR04P_STATUS_REJECTED)
+        return false;
+    
+    // 에코 없음/범위 밖은 앞에 아무것도 없는 것으로 취급
+    near = ok && sample->distance_mm <= p->cfg.near_mm;
+    far = !ok || sample->distance_mm > p->cfg.far_mm;
+    
+    if (p->state == HC_SR04P_PRESENCE_ABSENT) {
+        p->run = near ? p->run + 1 : 0;
+        if (p->run < count)
+            return false;
+        p->state = HC_SR04P_PRESENCE_PRESENT;
+    } else {
+        if (near)
+            p->last_near_ns = sample->pulse_end_ns;
+        p->run = far ? p->run + 1 : 0;
+        if (p->run < count ||
+            sample->pulse_end_ns - p->last_near_ns < (s64)p->cfg.hold_ms * NSEC_PER_MSEC)
+            return false;
+        p->state = HC_SR04P_PRESENCE_ABSENT;
+    }
+    
+    p->run = 0;
+    p->last_near_ns = sample->pulse_end_ns;
+    
+    event.timestamp_ns = sample->pulse_end_ns;
+    event.state = p->state;
+    event.distance_mm = sample->distance_mm;
+    if (!kfifo_put(&data->events, event)) {
+        data->events_dropped++;
+        return false;
+    }
+    
+    return true;
+}
+
+// 측정 결과를 레코드로 만들어 FIFO에 적재 (sample_lock 보유 상태에서 호출)
+// 반환값: wait_queue의 읽기 대기자를 깨워야 하면 true
+static bool publish_sample(struct sensor_data *data, u32 status) {
+    struct hc_sr04p_sample *sample = &data->last;
+    bool wake;
+    
+    write_seqcount_begin(&data->last_seqcount);
+    sample->pulse_start_ns = ktime_to_ns(data->pulse_start);
+    sample->pulse_end_ns = ktime_to_ns(data->pulse_end);
+    sample->distance_mm = data->distance_mm;
+    sample->status = status;
+    sample->seq = data->seq++;
+    sample->raw_mm = data->raw_mm;
+    write_seqcount_end(&data->last_seqcount);
+    
+    if (status != HC_SR04P_STATUS_OK)
+        trace_hc_sr04p_rejected(data->index, status, sample->seq);
+    
+    switch (status) {
+    case HC_SR04P_STATUS_OK:
+        stat_inc(data, STAT_VALID);
+        break;
+    case HC_SR04P_STATUS_OUT_OF_RANGE:
+        stat_inc(data, STAT_OUT_OF_RANGE);
+        break;
+    case HC_SR04P_STATUS_REJECTED:
+        stat_inc(data, STAT_REJECTED);
+        break;
+    default:
+        stat_inc(data, STAT_TIMEOUTS);
+        break;
+    }
+    
+    // mmap 링은 임계값과 무관하게 모든 레코드를 기록 (대기자는 ring_wait에서 따로 깨움)
+    ring_push(data, sample);
+    
+    wake = presence_update(data, sample);
+    
+    if (!sample_hz)
+        return true;
+    
+    // 필터가 버린 샘플은 스트림에 넣지 않음
+    if (status == HC_SR04P_STATUS_REJECTED)
+        return wake;
+    
+    // 임계값이 설정되어 있으면 구간이 바뀐 샘플만 전달
+    if (data->far_mm && !zone_changed(data, data->distance_mm))
+        return wake;
+    
+    if (!kfifo_put(&data->samples, *sample)) {
+        data->samples_dropped++;
+        return wake;
+    }
+    
+    return true;
+}
+
+// 마지막 측정 결과의 일관된 스냅샷 (락 없음, IRQ 스레드와 경합하면 다시 읽음)
+// 반환값: 다음에 발행될 순번 (0이면 아직 결과 없음)
+static u32 sensor_snapshot(struct sensor_data *data, struct hc_sr04p_sample *sample) {
+    unsigned int start;
+    u32 seq;
+    
+    do {
+        start = read_seqcount_begin(&data->last_seqcount);
+        *sample = data->last;
+        seq = data->seq;
+    } while (read_seqcount_retry(&data->last_seqcount, start));
+    
+    return seq;
+}
+
+static void sched_complete(struct sensor_data *data);
+
+// 인터럽트 상반부 (ECHO 핀의 rising/falling edge)
+// hardirq에서는 타임스탬프만 기록하고, edge 방향은 GPIO를 읽지 않고 측정 상태로 판단
 static irqreturn_t echo_irq_handler(int irq, void *dev_id) {
     struct sensor_data *data = (struct sensor_data *)dev_id;
+    ktime_t now = ktime_get();
     
-    if (gpio_get_value(ECHO_PIN)) {
+    switch (atomic_read(&data->state)) {
+    case SENSOR_TRIGGERED:
         // Rising edge: 펄스 시작
-        data->pulse_start = ktime_get();
-        pr_debug("[HC-SR04P]: Pulse started\n");
-    } else {
-        // Falling edge: 펄스 끝
-        data->pulse_end = ktime_get();
-        
-        // 거리 계산
-        s64 pulse_duration_ns = ktime_to_ns(ktime_sub(data->pulse_end, data->pulse_start));
-        int pulse_duration_us = (int)(pulse_duration_ns / 1000);
-        
-        // 유효성 검사 (20μs ~ 38ms: 3mm ~ 6.5m)
-        if (pulse_duration_us >= 20 && pulse_duration_us <= 38000) {
-            data->distance_mm = (pulse_duration_us * 10) / 58;  // mm 단위
-            atomic_set(&data->measurement_ready, 1);
-        } else {
-            data->distance_mm = -1;  // 오류 표시
-            atomic_set(&data->measurement_ready, -1);
+        if (atomic_cmpxchg(&data->state, SENSOR_TRIGGERED, SENSOR_ECHO_HIGH) == SENSOR_TRIGGERED) {
+            data->pulse_start = now;
+            trace_hc_sr04p_rising(data->index);
         }
+        return IRQ_HANDLED;
         
-        data->state = SENSOR_IDLE;
-        wake_up_interruptible(&data->wait_queue);
+    case SENSOR_ECHO_HIGH:
+        // Falling edge: 나머지 처리는 스레드 핸들러에서
+        data->edge_time = now;
+        return IRQ_WAKE_THREAD;
         
-        pr_debug("[HC-SR04P]: Distance: %d mm (pulse: %d μs)\n", 
-                data->distance_mm, pulse_duration_us);
+    default:
+        // 트리거하지 않은 edge는 무시
+        return IRQ_HANDLED;
     }
+}
+
+// 인터럽트 하반부 (스레드): falling edge 검증, 거리 변환, 결과 발행
+static irqreturn_t echo_irq_thread(int irq, void *dev_id) {
+    struct sensor_data *data = (struct sensor_data *)dev_id;
+    ktime_t thread_start = ktime_get();
+    unsigned long flags;
+    bool wake;
+    s64 skew_ns;
+    
+    // 노이즈로 생긴 edge면 펄스가 아직 HIGH이므로 측정을 계속 진행
+    if (gpio_get_value_cansleep(data->echo_pin))
+        return IRQ_HANDLED;
+    
+    spin_lock_irqsave(&data->sample_lock, flags);
+    
+    // 타임아웃으로 이미 끝난 측정이면 무시
+    if (atomic_cmpxchg(&data->state, SENSOR_ECHO_HIGH, SENSOR_DONE) != SENSOR_ECHO_HIGH) {
+        spin_unlock_irqrestore(&data->sample_lock, flags);
+        return IRQ_HANDLED;
+    }
+    data->pulse_end = data->edge_time;
+    hrtimer_try_to_cancel(&data->deadline_timer);
+    
+    // IRQ 타임스탬프와 스레드 실행 시점의 차이 (스레드에서 시각을 쟀다면 생겼을 오차)
+    skew_ns = ktime_to_ns(ktime_sub(thread_start, data->edge_time));
+    data->irq_skew_last_ns = skew_ns;
+    data->irq_skew_max_ns = max(data->irq_skew_max_ns, skew_ns);
+    data->irq_skew_total_ns += skew_ns;
+    data->irq_skew_count++;
+    
+    // 거리 계산
+    s64 pulse_duration_ns = ktime_to_ns(ktime_sub(data->pulse_end, data->pulse_start));
+    
+    hist_add(data, HIST_ECHO_WIDTH, pulse_duration_ns);
+    hist_add(data, HIST_TRIGGER_RISING, ktime_to_ns(ktime_sub(data->pulse_start, data->last_trigger)));
+    
+    // 유효성 검사 (20μs ~ 38ms: 3mm ~ 6.5m)
+    data->raw_mm = hc_sr04p_pulse_to_mm(pulse_duration_ns);
+    if (data->raw_mm >= 0) {
+        data->distance_mm = filter_apply(&data->filter, data->raw_mm);
+        trace_hc_sr04p_falling(data->index, pulse_duration_ns, data->raw_mm, data->distance_mm);
+        if (data->distance_mm >= 0)
+            wake = publish_sample(data, HC_SR04P_STATUS_OK);
+        else
+            wake = publish_sample(data, HC_SR04P_STATUS_REJECTED);
+    } else {
+        data->distance_mm = -1;  // 오류 표시
+        trace_hc_sr04p_falling(data->index, pulse_duration_ns, -1, -1);
+        wake = publish_sample(data, HC_SR04P_STATUS_OUT_OF_RANGE);
+    }
+    
+    spin_unlock_irqrestore(&data->sample_lock, flags);
+    
+    if (wake)
+        wake_up_interruptible(&data->wait_queue);
+    
+    // 에코 채널이 비었으므로 다음 센서 트리거
+    sched_complete(data);
+    
+    hist_add(data, HIST_IRQ_HANDLER, ktime_to_ns(ktime_sub(ktime_get(), data->edge_time)));
     
     return IRQ_HANDLED;
 }
 
-// 측정 트리거 함수
-static int trigger_measurement(void) {
-    unsigned long now = jiffies;
+// 측정이 진행 중인 상태인지 확인
+static bool sensor_busy(int state) {
+    return state == SENSOR_TRIGGERED || state == SENSOR_ECHO_HIGH;
+}
+
+// 트리거 펄스 종료 (hrtimer, CPU를 점유하지 않음)
+static enum hrtimer_restart trigger_timer_fn(struct hrtimer *timer) {
+    struct sensor_data *data = container_of(timer, struct sensor_data, trigger_timer);
+    
+    gpio_set_value(data->trigger_pin, 0);
+    return HRTIMER_NORESTART;
+}
+
+// 슬립 가능한 트리거 핀의 펄스 생성 (프로세스 컨텍스트)
+static void trigger_work_fn(struct work_struct *work) {
+    struct sensor_data *data = container_of(work, struct sensor_data, trigger_work);
+    
+    gpio_set_value_cansleep(data->trigger_pin, 1);
+    usleep_range(TRIGGER_PULSE_US, 2 * TRIGGER_PULSE_US);
+    gpio_set_value_cansleep(data->trigger_pin, 0);
+}
+
+// 측정 트리거 함수: 트리거 핀을 올리고 펄스 종료는 hrtimer에 맡김
+// (슬립 가능한 핀이면 펄스는 trigger_work가 생성, 에코 제한 시간은 여기서부터 잼)
+// 스케줄러만 호출 (sched.lock 보유 상태)
+static int trigger_measurement(struct sensor_data *data, ktime_t now) {
+    unsigned long flags;
+    int old;
     
     // 최소 60ms 간격 보장 (센서 스펙)
-    if (time_before(now, sensor_dev->last_trigger_time + msecs_to_jiffies(60))) {
+    if (ktime_before(now, ktime_add_ms(data->last_trigger, MIN_INTERVAL_MS))) {
+        stat_inc(data, STAT_SCHED_RETRIES);
         return -EBUSY;
     }
     
-    if (sensor_dev->state != SENSOR_IDLE) {
+    // 결과 발행 도중에 새 측정이 끼어들지 않도록 sample_lock 안에서 전이
+    spin_lock_irqsave(&data->sample_lock, flags);
+    
+    old = atomic_read(&data->state);
+    if (sensor_busy(old) || atomic_cmpxchg(&data->state, old, SENSOR_TRIGGERED) != old) {
+        spin_unlock_irqrestore(&data->sample_lock, flags);
+        stat_inc(data, STAT_SCHED_RETRIES);
         return -EBUSY;
     }
     
-    sensor_dev->state = SENSOR_MEASURING;
-    atomic_set(&sensor_dev->measurement_ready, 0);
+    data->pulse_start = 0;
+    data->last_trigger = now;
     
-    // 10μs 트리거 펄스
-    gpio_set_value(TRIGGER_PIN, 1);
-    udelay(15);  // 10μs 이상
-    gpio_set_value(TRIGGER_PIN, 0);
+    if (data->trigger_cansleep) {
+        queue_work(system_highpri_wq, &data->trigger_work);
+    } else {
+        gpio_set_value(data->trigger_pin, 1);
+        hrtimer_start(&data->trigger_timer, us_to_ktime(TRIGGER_PULSE_US), HRTIMER_MODE_REL_HARD);
+    }
+    hrtimer_start(&data->deadline_timer, ms_to_ktime(ECHO_DEADLINE_MS), HRTIMER_MODE_REL);
     
-    sensor_dev->last_trigger_time = now;
+    spin_unlock_irqrestore(&data->sample_lock, flags);
     
+    stat_inc(data, STAT_TRIGGERS);
+    trace_hc_sr04p_trigger(data->index);
     return 0;
 }
 
-// 디바이스 읽기 함수
-static ssize_t device_read(struct file *filp, char __user *buffer, size_t len, loff_t *offset) {
-    char result[32];  // ✅ 수정: 배열로 제대로 선언
-    int ret;
-    size_t result_len;
+// 진행 중인 측정을 타임아웃으로 종료하고 결과 발행
+// rising edge를 못 받았으면 NO_ECHO, falling edge를 못 받았으면 ECHO_STUCK으로 기록
+// 반환값: 이 호출이 측정을 종료했으면 true
+static bool timeout_measurement(struct sensor_data *data) {
+    unsigned long flags;
+    bool wake;
+    u32 status;
+    int old, prev;
+    
+    spin_lock_irqsave(&data->sample_lock, flags);
+    
+    // rising edge 처리와 경합할 수 있으므로 cmpxchg로 측정을 가져옴
+    old = atomic_read(&data->state);
+    while (sensor_busy(old)) {
+        prev = atomic_cmpxchg(&data->state, old, SENSOR_TIMEOUT);
+        if (prev == old)
+            break;
+        old = prev;
+    }
+    
+    if (!sensor_busy(old)) {
+        spin_unlock_irqrestore(&data->sample_lock, flags);
+        return false;
+    }
+    
+    status = old == SENSOR_TRIGGERED ? HC_SR04P_STATUS_NO_ECHO : HC_SR04P_STATUS_ECHO_STUCK;
+    data->pulse_end = ktime_get();
+    data->raw_mm = -1;
+    data->distance_mm = -1;
+    wake = publish_sample(data, status);
+    
+    spin_unlock_irqrestore(&data->sample_lock, flags);
+    
+    if (wake)
+        wake_up_interruptible(&data->wait_queue);
+    
+    sched_complete(data);
+    
+    return true;
+}
 
-    pr_info("[HC-SR04P]: Read request started\n");
+// 에코 제한 시간 초과: 측정을 끝내고 센서를 바로 다음 트리거 가능 상태로 되돌림
+static enum hrtimer_restart deadline_timer_fn(struct hrtimer *timer) {
+    struct sensor_data *data = container_of(timer, struct sensor_data, deadline_timer);
+    
+    timeout_measurement(data);
+    return HRTIMER_NORESTART;
+}
 
-    if (*offset > 0)
-        return 0;  // EOF
+// 센서가 트리거 조건을 만족하는 시각 (요청이 없으면 KTIME_MAX)
+static ktime_t sched_ready_time(struct sensor_data *data) {
+    ktime_t ready;
+    
+    if (data->trigger_pending)
+        ready = 0;
+    else if (sample_hz)
+        ready = data->next_due;
+    else
+        return KTIME_MAX;
+    
+    return max(ready, ktime_add_ms(data->last_trigger, MIN_INTERVAL_MS));
+}
+
+// 다음에 트리거할 센서 선택 (sched.lock 보유 상태에서 호출)
+// 에코 채널이 비어 있고 센서 간 간격이 지났으면 라운드 로빈 순서로 준비된 센서를 트리거,
+// 아니면 가장 빠른 가능 시각에 타이머를 맞춤
+static void sched_run_locked(void) {
+    ktime_t now = ktime_get();
+    ktime_t earliest = KTIME_MAX;
+    ktime_t gate, ready;
+    struct sensor_data *data;
+    unsigned int i, idx;
+    
+    if (sched.stopping || sched.active)
+        return;
+    
+    gate = ktime_add_ms(sched.last_trigger, stagger_ms);
+    
+    for (i = 0; i < num_sensors; i++) {
+        idx = (sched.next + i) % num_sensors;
+        data = sensors[idx];
+        
+        ready = sched_ready_time(data);
+        if (ready == KTIME_MAX)
+            continue;
+        ready = max(ready, gate);
+        
+        if (ktime_after(ready, now) || trigger_measurement(data, now)) {
+            earliest = min(earliest, ready);
+            continue;
+        }
+        
+        data->trigger_pending = false;
+        if (sample_hz) {
+            // 밀린 주기는 따라잡지 않음 (채널이 포화되면 라운드 로빈으로 공평하게 분배)
+            data->next_due = ktime_add(data->next_due, sched.period);
+            if (ktime_before(data->next_due, now))
+                data->next_due = now;
+        }
+        
+        // 에코 채널은 측정 완료 또는 에코 제한 시간 초과(sched_complete)로 비워짐
+        sched.active = data;
+        sched.next = idx + 1;
+        sched.last_trigger = now;
+        return;
+    }
+    
+    if (earliest != KTIME_MAX)
+        hrtimer_start(&sched.timer, earliest, HRTIMER_MODE_ABS);
+}
+
+// 측정 완료 알림: 에코 채널을 비우고 다음 센서 트리거
+static void sched_complete(struct sensor_data *data) {
+    unsigned long flags;
+    
+    spin_lock_irqsave(&sched.lock, flags);
+    if (sched.active == data)
+        sched.active = NULL;
+    sched_run_locked();
+    spin_unlock_irqrestore(&sched.lock, flags);
+}
+
+// 읽기 요청으로 측정 예약
+static void sched_request(struct sensor_data *data) {
+    unsigned long flags;
+    
+    spin_lock_irqsave(&sched.lock, flags);
+    data->trigger_pending = true;
+    sched_run_locked();
+    spin_unlock_irqrestore(&sched.lock, flags);
+}
+
+// 스케줄러 타이머: 예약된 트리거 시각
+static enum hrtimer_restart sched_timer_fn(struct hrtimer *timer) {
+    unsigned long flags;
+    
+    spin_lock_irqsave(&sched.lock, flags);
+    sched_run_locked();
+    spin_unlock_irqrestore(&sched.lock, flags);
+    
+    return HRTIMER_NORESTART;
+}
+
+// 연속 측정 모드 읽기: 쌓여 있는 샘플을 "타임스탬프(ns) 거리(mm)" 줄 단위로 반환
+// 바이너리 모드에서는 버퍼에 들어가는 만큼 struct hc_sr04p_sample 레코드를 한 번에 반환
+static ssize_t device_read_stream(struct file *filp, char __user *buffer, size_t len) {
+    struct sensor_file *priv = filp->private_data;
+    struct sensor_data *sensor_dev = priv->sensor;
+    struct hc_sr04p_sample sample;
+    char line[48];
+    size_t line_len;
+    unsigned int copied = 0;
+    int ret;
+    
+    if (priv->format == HC_SR04P_FMT_BINARY && len < sizeof(sample))
+        return -EINVAL;
     
     if (mutex_lock_interruptible(&sensor_dev->lock))
         return -ERESTARTSYS;
+    
+    // 샘플이 하나라도 쌓일 때까지 대기 (트리거는 타이머가 담당)
+    while (kfifo_is_empty(&sensor_dev->samples)) {
+        mutex_unlock(&sensor_dev->lock);
+        
+        if (filp->f_flags & O_NONBLOCK)
+            return -EAGAIN;
+        
+        ret = wait_event_interruptible(sensor_dev->wait_queue,
+                                       !kfifo_is_empty(&sensor_dev->samples));
+        if (ret)
+            return ret;
+        
+        trace_hc_sr04p_reader_woken(sensor_dev->index, READ_ONCE(sensor_dev->seq));
+        
+        if (mutex_lock_interruptible(&sensor_dev->lock))
+            return -ERESTARTSYS;
+    }
+    
+    if (priv->format == HC_SR04P_FMT_BINARY) {
+        ret = kfifo_to_user(&sensor_dev->samples, buffer, len, &copied);
+        mutex_unlock(&sensor_dev->lock);
+        if (ret)
+            return ret;
+        return copied;
+    }
+    
+    // 버퍼에 들어가는 만큼 샘플을 꺼내서 전달
+    while (kfifo_peek(&sensor_dev->samples, &sample)) {
+        if (sample.status == HC_SR04P_STATUS_OK)
+            line_len = snprintf(line, sizeof(line), "%lld %d\n",
+                                sample.pulse_end_ns, sample.distance_mm);
+        else
+            line_len = snprintf(line, sizeof(line), "%lld ERROR\n",
+                                sample.pulse_end_ns);
+        
+        if (len - copied < line_len)
+            break;
+        
+        if (copy_to_user(buffer + copied, line, line_len)) {
+            mutex_unlock(&sensor_dev->lock);
+            if (!copied)
+                return -EFAULT;
+            return copied;
+        }
+        
+        kfifo_skip(&sensor_dev->samples);
+        copied += line_len;
+    }
+    
+    mutex_unlock(&sensor_dev->lock);
+    
+    if (!copied)
+        return -EINVAL;
+    
+    return copied;
+}
 
-    // 상태 초기화
-    sensor_dev->state = SENSOR_IDLE;
-    atomic_set(&sensor_dev->measurement_ready, 0);
-
-    // 새로운 측정 시작
-    ret = trigger_measurement();
-    if (ret) {
-        pr_err("[HC-SR04P]: Trigger failed: %d\n", ret);
+// 재실 이벤트 읽기: 쌓여 있는 struct hc_sr04p_event를 버퍼에 들어가는 만큼 반환
+static ssize_t device_read_events(struct file *filp, char __user *buffer, size_t len) {
+    struct sensor_file *priv = filp->private_data;
+    struct sensor_data *sensor_dev = priv->sensor;
+    unsigned int copied;
+    int ret;
+    
+    if (len < sizeof(struct hc_sr04p_event))
+        return -EINVAL;
+    
+    if (mutex_lock_interruptible(&sensor_dev->lock))
+        return -ERESTARTSYS;
+    
+    while (kfifo_is_empty(&sensor_dev->events)) {
         mutex_unlock(&sensor_dev->lock);
-        return ret;
+        
+        if (filp->f_flags & O_NONBLOCK)
+            return -EAGAIN;
+        
+        ret = wait_event_interruptible(sensor_dev->wait_queue,
+                                       !kfifo_is_empty(&sensor_dev->events));
+        if (ret)
+            return ret;
+        
+        if (mutex_lock_interruptible(&sensor_dev->lock))
+            return -ERESTARTSYS;
     }
     
+    ret = kfifo_to_user(&sensor_dev->events, buffer, len, &copied);
     mutex_unlock(&sensor_dev->lock);
+    if (ret)
+        return ret;
+    
+    return copied;
+}
+
+// 측정 결과 가져오기 (여러 읽기 요청을 측정 하나로 합침)
+// 완료 후 max_age_ns가 지나지 않은 결과가 있으면 바로 반환하고, 아니면 진행 중인 측정에 합류하거나
+// 새 측정을 예약해서 그 결과를 기다림 (결과가 발행되면 기다리던 읽기 요청을 모두 깨움)
+// 논블로킹이면 예약만 하고 -EAGAIN, 결과가 나오면 poll()이 읽기 가능을 알림
+// max_age_ns가 MAX_AGE_NEXT_TRIGGER면 완료 시각이 아니라 트리거 시각 + 최소 간격까지 재사용
+// (그 전에는 새로 트리거할 수 없으므로 기다려도 같은 센서 상태)
+static int sensor_get_sample(struct sensor_file *priv, bool nonblock, s64 max_age_ns,
+                             struct hc_sr04p_sample *sample) {
+    struct sensor_data *sensor_dev = priv->sensor;
+    ktime_t now = ktime_get();
+    bool busy, fresh;
+    u32 seq;
+    int ret;
+    
+    // 스냅샷 후 상태를 읽어야, 그 사이 끝난 측정이 있어도 seq 변화로 감지됨
+    seq = sensor_snapshot(sensor_dev, sample);
+    busy = sensor_busy(atomic_read(&sensor_dev->state));
+    
+    // poll()로 기다리던 측정이 끝났으면 그 결과 반환
+    if (priv->waiting && seq != priv->wait_seq) {
+        priv->waiting = false;
+        return 0;
+    }
+    
+    // 나이 기준을 만족하면 다음 측정이 진행 중이어도 캐시된 결과 반환 (너무 오래됐을 때만 합류)
+    // MAX_AGE_NEXT_TRIGGER의 last_trigger는 진행 중인 측정의 트리거일 수 있으므로 측정 중이 아닐 때만 적용
+    if (max_age_ns == MAX_AGE_NEXT_TRIGGER)
+        fresh = !busy && ktime_before(now, ktime_add_ms(READ_ONCE(sensor_dev->last_trigger),
+                                                        MIN_INTERVAL_MS));
+    else
+        fresh = ktime_to_ns(now) - sample->pulse_end_ns <= max_age_ns;
+    
+    if (seq && fresh) {
+        priv->waiting = false;
+        return 0;
+    }
     
-    // 측정 완료 대기 (최대 2초)
+    // 연속 측정 모드에서는 스케줄러가 주기적으로 측정하므로 새로 예약하지 않음
+    if (sample_hz)
+        return -ENODATA;
+    
+    // 진행 중인 측정이 없으면 예약 (다른 센서가 측정 중이거나 최소 간격 전이면 가능한 시점에 트리거)
+    if (!busy)
+        sched_request(sensor_dev);
+    
+    priv->waiting = true;
+    priv->wait_seq = seq;
+    
+    if (nonblock)
+        return -EAGAIN;
+    
+    // 측정 완료 대기: 보통 에코 제한 시간(45ms) 안에 끝나며,
+    // 2초는 스케줄러 대기열까지 포함한 안전장치
     ret = wait_event_interruptible_timeout(
         sensor_dev->wait_queue,
-        atomic_read(&sensor_dev->measurement_ready) != 0,
+        READ_ONCE(sensor_dev->seq) != seq,
         msecs_to_jiffies(2000)
     );
     
     if (ret == 0) {
+        // 에코를 놓친 측정을 정리해서 다음 트리거가 가능하도록 함
+        timeout_measurement(sensor_dev);
+        priv->waiting = false;
         pr_err("[HC-SR04P]: Measurement timeout\n");
         return -ETIMEDOUT;
     } else if (ret < 0) {
         return ret;
     }
     
+    sensor_snapshot(sensor_dev, sample);
+    priv->waiting = false;
+    trace_hc_sr04p_reader_woken(sensor_dev->index, sample->seq);
+    
+    return 0;
+}
+
+// 디바이스 읽기 함수
+static ssize_t sensor_read(struct file *filp, char __user *buffer, size_t len, loff_t *offset) {
+    struct sensor_file *priv = filp->private_data;
+    struct hc_sr04p_sample sample;
+    char result[32];  // ✅ 수정: 배열로 제대로 선언
+    int ret;
+    size_t result_len;
+
+    if (priv->format == HC_SR04P_FMT_EVENTS)
+        return device_read_events(filp, buffer, len);
+
+    if (sample_hz)
+        return device_read_stream(filp, buffer, len);
+
+    // 바이너리 모드는 EOF 없이 읽을 때마다 레코드 하나를 반환
+    if (priv->format == HC_SR04P_FMT_BINARY) {
+        if (len < sizeof(sample))
+            return -EINVAL;
+    } else if (*offset > 0) {
+        return 0;  // EOF
+    }
+    
+    // 트리거 후 최소 측정 간격이 지나기 전이면 (새로 트리거할 수 없으므로) 마지막 결과를 공유
+    ret = sensor_get_sample(priv, filp->f_flags & O_NONBLOCK,
+                            MAX_AGE_NEXT_TRIGGER, &sample);
+    if (ret)
+        return ret;
+    
+    if (priv->format == HC_SR04P_FMT_BINARY) {
+        if (copy_to_user(buffer, &sample, sizeof(sample)))
+            return -EFAULT;
+        return sizeof(sample);
+    }
+    
     // 거리 데이터를 문자열로 변환
-    if (atomic_read(&sensor_dev->measurement_ready) > 0) {
-        result_len = snprintf(result, sizeof(result), "%d\n", sensor_dev->distance_mm);
+    if (sample.status == HC_SR04P_STATUS_OK) {
+        result_len = snprintf(result, sizeof(result), "%d\n", sample.distance_mm);
     } else {
         result_len = snprintf(result, sizeof(result), "ERROR\n");
     }
@@ -177,125 +1084,807 @@ static ssize_t device_read(struct file *filp, char __user *buffer, size_t len, l
     return result_len;
 }
 
+// 읽기 지연과 시그널 중단 횟수 기록
+static ssize_t device_read(struct file *filp, char __user *buffer, size_t len, loff_t *offset) {
+    struct sensor_file *priv = filp->private_data;
+    ktime_t start = ktime_get();
+    s64 latency_ns;
+    ssize_t ret;
+    
+    ret = sensor_read(filp, buffer, len, offset);
+    
+    if (ret == -ERESTARTSYS)
+        stat_inc(priv->sensor, STAT_ERESTARTSYS);
+    latency_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+    hist_add(priv->sensor, HIST_READ_LATENCY, latency_ns);
+    trace_hc_sr04p_read_return(priv->sensor->index, ret, latency_ns);
+    
+    return ret;
+}
+
+// 디바이스 열기: minor 번호에 해당하는 센서와 파일별 읽기 형식 상태 할당
+static int device_open(struct inode *inode, struct file *filp) {
+    struct sensor_file *priv;
+    
+    priv = kzalloc(sizeof(*priv), GFP_KERNEL);
+    if (!priv)
+        return -ENOMEM;
+    
+    priv->sensor = container_of(inode->i_cdev, struct sensor_data, char_dev);
+    priv->format = HC_SR04P_FMT_TEXT;
+    filp->private_data = priv;
+    return 0;
+}
+
+static int device_release(struct inode *inode, struct file *filp) {
+    kfree(filp->private_data);
+    return 0;
+}
+
+// mmap 지원: 링 버퍼를 사용자 공간에 그대로 노출 (copy_to_user 없음)
+static int device_mmap(struct file *filp, struct vm_area_struct *vma) {
+    struct sensor_file *priv = filp->private_data;
+    struct sensor_data *sensor_dev = priv->sensor;
+    int ret;
+    
+    if (vma->vm_pgoff || vma->vm_end - vma->vm_start > sensor_dev->ring_size)
+        return -EINVAL;
+    
+    ret = remap_vmalloc_range(vma, sensor_dev->ring, 0);
+    if (ret)
+        return ret;
+    
+    priv->mapped = true;
+    return 0;
+}
+
+// poll/epoll 지원
+static __poll_t device_poll(struct file *filp, poll_table *wait) {
+    struct sensor_file *priv = filp->private_data;
+    struct sensor_data *sensor_dev = priv->sensor;
+    __poll_t mask = 0;
+    u32 head;
+    
+    // mmap 소비자는 링 전용 대기열만 봄 (샘플마다 깨지 않도록)
+    if (priv->mapped && priv->format != HC_SR04P_FMT_EVENTS)
+        poll_wait(filp, &sensor_dev->ring_wait, wait);
+    else
+        poll_wait(filp, &sensor_dev->wait_queue, wait);
+    
+    if (priv->format == HC_SR04P_FMT_EVENTS) {
+        // 재실 이벤트 소비자
+        if (!kfifo_is_empty(&sensor_dev->events))
+            mask |= EPOLLIN | EPOLLRDNORM;
+    } else if (priv->mapped) {
+        // mmap 소비자: 링에 읽지 않은 레코드가 있으면 읽기 가능
+        head = READ_ONCE(sensor_dev->ring_head);
+        if (head != ring_tail(sensor_dev, head))
+            mask |= EPOLLIN | EPOLLRDNORM;
+    } else if (sample_hz) {
+        if (!kfifo_is_empty(&sensor_dev->samples))
+            mask |= EPOLLIN | EPOLLRDNORM;
+    } else {
+        // 읽기 시 측정 모드: 논블로킹 read()로 예약한 측정이 끝났으면 읽기 가능
+        if (priv->waiting && READ_ONCE(sensor_dev->seq) != priv->wait_seq)
+            mask |= EPOLLIN | EPOLLRDNORM;
+    }
+    
+    return mask;
+}
+
+// IOCTL 함수
+static long device_ioctl(struct file *filp, unsigned int cmd, unsigned long arg) {
+    struct sensor_file *priv = filp->private_data;
+    struct sensor_data *sensor_dev = priv->sensor;
+    struct hc_sr04p_latest latest;
+    struct hc_sr04p_presence presence;
+    int params[2];
+    unsigned long flags;
+    int ret;
+    
+    switch (cmd) {
+    case HC_SR04P_IOC_SET_THRESHOLD:
+        // 같은 센서를 연 다른 프로세스의 샘플 스트림까지 바뀌므로 관리자만 변경
+        if (!capable(CAP_SYS_ADMIN))
+            return -EPERM;
+        if (copy_from_user(params, (int __user *)arg, sizeof(params)))
+            return -EFAULT;
+        
+        // near <= far 사이 구간은 히스테리시스로 사용
+        if ((params[0] || params[1]) && (params[0] <= 0 || params[1] < params[0]))
+            return -EINVAL;
+        
+        spin_lock_irqsave(&sensor_dev->sample_lock, flags);
+        sensor_dev->near_mm = params[0];
+        sensor_dev->far_mm = params[1];
+        sensor_dev->zone = ZONE_UNKNOWN;
+        spin_unlock_irqrestore(&sensor_dev->sample_lock, flags);
+        return 0;
+        
+    case HC_SR04P_IOC_SET_FORMAT:
+        // _IO 명령: 형식 값 자체가 arg
+        if (arg != HC_SR04P_FMT_TEXT && arg != HC_SR04P_FMT_BINARY &&
+            arg != HC_SR04P_FMT_EVENTS)
+            return -EINVAL;
+        priv->format = arg;
+        return 0;
+        
+    case HC_SR04P_IOC_SET_PRESENCE:
+        // 이벤트 큐가 센서 하나에 하나라서 SET_THRESHOLD처럼 센서 전체 설정
+        if (!capable(CAP_SYS_ADMIN))
+            return -EPERM;
+        if (copy_from_user(&presence, (void __user *)arg, sizeof(presence)))
+            return -EFAULT;
+        
+        if ((presence.near_mm || presence.far_mm) &&
+            (presence.near_mm <= 0 || presence.far_mm < presence.near_mm))
+            return -EINVAL;
+        if (presence.hold_ms > PRESENCE_HOLD_MAX_MS)
+            return -EINVAL;
+        
+        // 설정이 바뀌면 ABSENT부터 다시 판정
+        spin_lock_irqsave(&sensor_dev->sample_lock, flags);
+        sensor_dev->presence.cfg = presence;
+        sensor_dev->presence.state = HC_SR04P_PRESENCE_ABSENT;
+        sensor_dev->presence.run = 0;
+        spin_unlock_irqrestore(&sensor_dev->sample_lock, flags);
+        return 0;
+        
+    case HC_SR04P_IOC_GET_LATEST:
+        if (copy_from_user(&latest, (void __user *)arg, sizeof(latest)))
+            return -EFAULT;
+        
+        ret = sensor_get_sample(priv, filp->f_flags & O_NONBLOCK,
+                                (s64)latest.max_age_ms * NSEC_PER_MSEC, &latest.sample);
+        if (ret == -ERESTARTSYS)
+            stat_inc(sensor_dev, STAT_ERESTARTSYS);
+        if (ret)
+            return ret;
+        
+        if (copy_to_user((void __user *)arg, &latest, sizeof(latest)))
+            return -EFAULT;
+        return 0;
+        
+    default:
+        return -ENOTTY;
+    }
+}
+
+// sysfs 속성: IRQ 타임스탬프 지연 (RT 커널에서 지터 비교용)
+static ssize_t irq_skew_last_ns_show(struct device *dev, struct device_attribute *attr, char *buf) {
+    struct sensor_data *data = dev_get_drvdata(dev);
+    s64 val;
+    
+    spin_lock_irq(&data->sample_lock);
+    val = data->irq_skew_last_ns;
+    spin_unlock_irq(&data->sample_lock);
+    
+    return sysfs_emit(buf, "%lld\n", val);
+}
+static DEVICE_ATTR_RO(irq_skew_last_ns);
+
+static ssize_t irq_skew_mean_ns_show(struct device *dev, struct device_attribute *attr, char *buf) {
+    struct sensor_data *data = dev_get_drvdata(dev);
+    s64 total;
+    u64 count;
+    
+    spin_lock_irq(&data->sample_lock);
+    total = data->irq_skew_total_ns;
+    count = data->irq_skew_count;
+    spin_unlock_irq(&data->sample_lock);
+    
+    return sysfs_emit(buf, "%lld\n", count ? div64_s64(total, count) : 0);
+}
+static DEVICE_ATTR_RO(irq_skew_mean_ns);
+
+static ssize_t irq_skew_max_ns_show(struct device *dev, struct device_attribute *attr, char *buf) {
+    struct sensor_data *data = dev_get_drvdata(dev);
+    s64 val;
+    
+    spin_lock_irq(&data->sample_lock);
+    val = data->irq_skew_max_ns;
+    spin_unlock_irq(&data->sample_lock);
+    
+    return sysfs_emit(buf, "%lld\n", val);
+}
+
+// 아무 값이나 쓰면 통계 초기화
+static ssize_t irq_skew_max_ns_store(struct device *dev, struct device_attribute *attr,
+                                     const char *buf, size_t count) {
+    struct sensor_data *data = dev_get_drvdata(dev);
+    
+    spin_lock_irq(&data->sample_lock);
+    data->irq_skew_max_ns = 0;
+    data->irq_skew_total_ns = 0;
+    data->irq_skew_count = 0;
+    spin_unlock_irq(&data->sample_lock);
+    
+    return count;
+}
+static DEVICE_ATTR_RW(irq_skew_max_ns);
+
+// sysfs 속성: 현재 재실 상태 (판정이 꺼져 있으면 disabled)
+static ssize_t presence_show(struct device *dev, struct device_attribute *attr, char *buf) {
+    struct sensor_data *data = dev_get_drvdata(dev);
+    bool enabled;
+    u32 state;
+    
+    spin_lock_irq(&data->sample_lock);
+    enabled = data->presence.cfg.far_mm;
+    state = data->presence.state;
+    spin_unlock_irq(&data->sample_lock);
+    
+    if (!enabled)
+        return sysfs_emit(buf, "disabled\n");
+    return sysfs_emit(buf, "%s\n", state == HC_SR04P_PRESENCE_PRESENT ? "present" : "absent");
+}
+static DEVICE_ATTR_RO(presence);
+
+// sysfs 속성: 거리 필터 설정 (변경 시 필터 상태 초기화)
+static ssize_t filter_show(struct device *dev, char *buf, unsigned int *field) {
+    struct sensor_data *data = dev_get_drvdata(dev);
+    unsigned int val;
+    
+    spin_lock_irq(&data->sample_lock);
+    val = *field;
+    spin_unlock_irq(&data->sample_lock);
+    
+    return sysfs_emit(buf, "%u\n", val);
+}
+
+static ssize_t filter_store(struct device *dev, const char *buf, size_t count,
+                            unsigned int *field, unsigned int max) {
+    struct sensor_data *data = dev_get_drvdata(dev);
+    unsigned int val;
+    int ret;
+    
+    ret = kstrtouint(buf, 0, &val);
+    if (ret)
+        return ret;
+    if (val > max)
+        return -EINVAL;
+    
+    spin_lock_irq(&data->sample_lock);
+    *field = val;
+    filter_reset(&data->filter);
+    spin_unlock_irq(&data->sample_lock);
+    
+    return count;
+}
+
+#define FILTER_ATTR(name, max)                                                          \
+static ssize_t filter_##name##_show(struct device *dev, struct device_attribute *attr,  \
+                                    char *buf) {                                        \
+    struct sensor_data *data = dev_get_drvdata(dev);                                    \
+    return filter_show(dev, buf, &data->filter.name);                                   \
+}                                                                                       \
+static ssize_t filter_##name##_store(struct device *dev, struct device_attribute *attr, \
+                                     const char *buf, size_t count) {                   \
+    struct sensor_data *data = dev_get_drvdata(dev);                                    \
+    return filter_store(dev, buf, count, &data->filter.name, max);                      \
+}                                                                                       \
+static DEVICE_ATTR_RW(filter_##name)
+
+FILTER_ATTR(ema_shift, FILTER_EMA_SHIFT_MAX);
+FILTER_ATTR(outlier_mm, FILTER_THRESHOLD_MAX);
+FILTER_ATTR(spike_mm, FILTER_THRESHOLD_MAX);
+
+// 중앙값 창은 홀수만 허용 (0, 1 = 사용 안 함)
+static ssize_t filter_median_show(struct device *dev, struct device_attribute *attr, char *buf) {
+    struct sensor_data *data = dev_get_drvdata(dev);
+    return filter_show(dev, buf, &data->filter.median);
+}
+
+static ssize_t filter_median_store(struct device *dev, struct device_attribute *attr,
+                                   const char *buf, size_t count) {
+    struct sensor_data *data = dev_get_drvdata(dev);
+    unsigned int val;
+    
+    if (kstrtouint(buf, 0, &val) == 0 && val > 1 && !(val & 1))
+        return -EINVAL;
+    
+    return filter_store(dev, buf, count, &data->filter.median, FILTER_MEDIAN_MAX);
+}
+static DEVICE_ATTR_RW(filter_median);
+
+static struct attribute *hc_sr04p_attrs[] = {
+    &dev_attr_irq_skew_last_ns.attr,
+    &dev_attr_irq_skew_mean_ns.attr,
+    &dev_attr_irq_skew_max_ns.attr,
+    &dev_attr_filter_median.attr,
+    &dev_attr_filter_ema_shift.attr,
+    &dev_attr_filter_outlier_mm.attr,
+    &dev_attr_filter_spike_mm.attr,
+    &dev_attr_presence.attr,
+    NULL,
+};
+ATTRIBUTE_GROUPS(hc_sr04p);
+
+#if IS_ENABLED(CONFIG_IIO_TRIGGERED_BUFFER)
+// IIO 백엔드: 문자 디바이스와 같은 측정 경로(스케줄러, 필터, 읽기 합류)를 공유
+// 버퍼 모드는 hrtimer 트리거(iio-trig-hrtimer, configfs로 생성)에 연결해서 사용
+struct sensor_iio {
+    struct sensor_data *data;
+    struct sensor_file file;    // 트리거 핸들러의 측정 대기 상태
+    bool pushed;
+    u32 pushed_seq;             // 같은 샘플을 두 번 넣지 않도록
+};
+
+static const struct iio_chan_spec sensor_iio_channels[] = {
+    {
+        .type = IIO_DISTANCE,
+        .info_mask_separate = BIT(IIO_CHAN_INFO_RAW) | BIT(IIO_CHAN_INFO_SCALE),
+        .scan_index = 0,
+        .scan_type = {
+            .sign = 's',
+            .realbits = 32,
+            .storagebits = 32,
+            .endianness = IIO_CPU,
+        },
+    },
+    IIO_CHAN_SOFT_TIMESTAMP(1),
+};
+
+// 측정 상태를 IIO 오류 코드로 변환
+static int sensor_iio_status(const struct hc_sr04p_sample *sample) {
+    switch (sample->status) {
+    case HC_SR04P_STATUS_OK:
+        return 0;
+    case HC_SR04P_STATUS_NO_ECHO:
+    case HC_SR04P_STATUS_ECHO_STUCK:
+        return -ETIMEDOUT;
+    default:
+        return -EIO;
+    }
+}
+
+static int sensor_iio_read_raw(struct iio_dev *indio_dev, struct iio_chan_spec const *chan,
+                               int *val, int *val2, long mask) {
+    struct sensor_iio *iio = iio_priv(indio_dev);
+    struct sensor_file file = { .sensor = iio->data };
+    struct hc_sr04p_sample sample;
+    int ret;
+    
+    switch (mask) {
+    case IIO_CHAN_INFO_RAW:
+        // 버퍼 모드에서는 트리거 핸들러가 측정을 담당
+        ret = iio_device_claim_direct_mode(indio_dev);
+        if (ret)
+            return ret;
+        // 연속 측정 모드에서는 스케줄러가 측정하므로 마지막 결과를 그대로 사용
+        if (sample_hz)
+            ret = sensor_snapshot(iio->data, &sample) ? 0 : -ENODATA;
+        else
+            ret = sensor_get_sample(&file, false, MAX_AGE_NEXT_TRIGGER, &sample);
+        iio_device_release_direct_mode(indio_dev);
+        if (!ret)
+            ret = sensor_iio_status(&sample);
+        if (ret)
+            return ret;
+        *val = sample.distance_mm;
+        return IIO_VAL_INT;
+        
+    case IIO_CHAN_INFO_SCALE:
+        // IIO 거리 단위는 m, raw는 mm
+        *val = 0;
+        *val2 = 1000;
+        return IIO_VAL_INT_PLUS_MICRO;
+        
+    default:
+        return -EINVAL;
+    }
+}
+
+static const struct iio_info sensor_iio_info = {
+    .read_raw = sensor_iio_read_raw,
+};
+
+// 트리거 핸들러 (스레드): 측정 하나를 기다려 버퍼에 넣음
+// 연속 측정 모드에서는 기다리지 않고 새로 들어온 샘플만 넣음
+static irqreturn_t sensor_iio_trigger_handler(int irq, void *p) {
+    struct iio_poll_func *pf = p;
+    struct iio_dev *indio_dev = pf->indio_dev;
+    struct sensor_iio *iio = iio_priv(indio_dev);
+    struct hc_sr04p_sample sample;
+    struct {
+        s32 distance_mm;
+        s64 timestamp __aligned(8);
+    } scan = { 0 };
+    s64 timestamp;
+    int ret;
+    
+    if (sample_hz) {
+        // 아직 측정 결과가 없으면 (seq 0) data->last는 초기값이라 넣지 않음
+        ret = sensor_snapshot(iio->data, &sample) ? 0 : -ENODATA;
+    } else {
+        ret = sensor_get_sample(&iio->file, false, MAX_AGE_NEXT_TRIGGER, &sample);
+    }
+    
+    if (ret || sensor_iio_status(&sample) || (iio->pushed && sample.seq == iio->pushed_seq))
+        goto done;
+    
+    iio->pushed = true;
+    iio->pushed_seq = sample.seq;
+    scan.distance_mm = sample.distance_mm;
+    
+    // 트리거 시각이 아니라 측정 시각 (CLOCK_MONOTONIC의 pulse_end를 IIO 디바이스 시계로 환산)
+    timestamp = iio_get_time_ns(indio_dev) - (ktime_get_ns() - sample.pulse_end_ns);
+    iio_push_to_buffers_with_timestamp(indio_dev, &scan, timestamp);
+    
+done:
+    iio_trigger_notify_done(indio_dev->trig);
+    return IRQ_HANDLED;
+}
+
+// IIO 디바이스 등록 (실패해도 문자 디바이스는 계속 동작)
+static void sensor_iio_register(struct sensor_data *data) {
+    struct iio_dev *indio_dev;
+    struct sensor_iio *iio;
+    int ret;
+    
+    indio_dev = iio_device_alloc(data->dev_device, sizeof(*iio));
+    if (!indio_dev) {
+        pr_warn("[HC-SR04P]: %s: Cannot allocate IIO device\n", data->name);
+        return;
+    }
+    
+    iio = iio_priv(indio_dev);
+    iio->data = data;
+    iio->file.sensor = data;
+    
+    indio_dev->name = data->name;
+    indio_dev->info = &sensor_iio_info;
+    indio_dev->modes = INDIO_DIRECT_MODE;
+    indio_dev->channels = sensor_iio_channels;
+    indio_dev->num_channels = ARRAY_SIZE(sensor_iio_channels);
+    
+    // 타임스탬프는 트리거 시각이 아니라 샘플의 측정 시각을 쓰므로 상반부 없음
+    ret = iio_triggered_buffer_setup(indio_dev, NULL, sensor_iio_trigger_handler, NULL);
+    if (ret)
+        goto err_free;
+    
+    ret = iio_device_register(indio_dev);
+    if (ret)
+        goto err_cleanup_buffer;
+    
+    data->indio_dev = indio_dev;
+    return;
+    
+err_cleanup_buffer:
+    iio_triggered_buffer_cleanup(indio_dev);
+err_free:
+    iio_device_free(indio_dev);
+    pr_warn("[HC-SR04P]: %s: Cannot register IIO device: %d\n", data->name, ret);
+}
+
+static void sensor_iio_unregister(struct sensor_data *data) {
+    if (!data->indio_dev)
+        return;
+    
+    iio_device_unregister(data->indio_dev);
+    iio_triggered_buffer_cleanup(data->indio_dev);
+    iio_device_free(data->indio_dev);
+}
+#else
+static void sensor_iio_register(struct sensor_data *data) {}
+static void sensor_iio_unregister(struct sensor_data *data) {}
+#endif
+
+// debugfs: 카운터
+static int stats_show(struct seq_file *m, void *v) {
+    struct sensor_data *data = m->private;
+    int i;
+    
+    for (i = 0; i < STAT_COUNT; i++)
+        seq_printf(m, "%-16s %lu\n", stat_names[i],
+                   (unsigned long)atomic_long_read(&data->stats.counters[i]));
+    
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(stats);
+
+// debugfs: 히스토그램 (비어 있는 구간은 생략)
+static int histograms_show(struct seq_file *m, void *v) {
+    struct sensor_data *data = m->private;
+    unsigned long count;
+    int h, b;
+    
+    for (h = 0; h < HIST_COUNT; h++) {
+        seq_printf(m, "%s:\n", hist_names[h]);
+        for (b = 0; b < HIST_BUCKETS; b++) {
+            count = atomic_long_read(&data->stats.hist[h][b]);
+            if (!count)
+                continue;
+            if (b == HIST_BUCKETS - 1)
+                seq_printf(m, "  %10llu ~            : %lu\n", 1ULL << (b - 1), count);
+            else
+                seq_printf(m, "  %10llu ~ %10llu : %lu\n",
+                           b ? 1ULL << (b - 1) : 0, (1ULL << b) - 1, count);
+        }
+    }
+    
+    return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(histograms);
+
+// debugfs: 아무 값이나 쓰면 카운터와 히스토그램 초기화
+static int stats_reset_set(void *arg, u64 val) {
+    struct sensor_data *data = arg;
+    int i, b;
+    
+    for (i = 0; i < STAT_COUNT; i++)
+        atomic_long_set(&data->stats.counters[i], 0);
+    for (i = 0; i < HIST_COUNT; i++)
+        for (b = 0; b < HIST_BUCKETS; b++)
+            atomic_long_set(&data->stats.hist[i][b], 0);
+    
+    return 0;
+}
+DEFINE_DEBUGFS_ATTRIBUTE(stats_reset_fops, NULL, stats_reset_set, "%llu\n");
+
 // 파일 오퍼레이션
 static const struct file_operations fops = {
+    .owner = THIS_MODULE,
+    .open = device_open,
+    .release = device_release,
     .read = device_read,
+    .poll = device_poll,
+    .mmap = device_mmap,
+    .unlocked_ioctl = device_ioctl,
 };
 
-// 모듈 초기화 (수정된 부분 - 권한 설정 추가)
-static int __init hc_sr04p_init(void) {
+// 센서 하나 등록 (GPIO, IRQ, 문자 디바이스)
+static int sensor_probe(unsigned int index) {
+    struct sensor_data *data;
     int ret;
     
-    pr_info("[HC-SR04P]: Initializing ultrasonic sensor driver\n");
-    
     // 메모리 할당
-    sensor_dev = kzalloc(sizeof(struct sensor_data), GFP_KERNEL);
-    if (!sensor_dev)
+    data = kzalloc(sizeof(struct sensor_data), GFP_KERNEL);
+    if (!data)
         return -ENOMEM;
     
+    data->index = index;
+    data->trigger_pin = trigger_pins[index];
+    data->echo_pin = echo_pins[index];
+    data->dev_number = MKDEV(MAJOR(sensor_devt), index);
+    
+    // 첫 번째 센서는 기존 이름(/dev/hc_sr04p)을 유지
+    if (index == 0)
+        snprintf(data->name, sizeof(data->name), "%s", DEVICE_NAME);
+    else
+        snprintf(data->name, sizeof(data->name), "%s%u", DEVICE_NAME, index);
+    snprintf(data->irq_name, sizeof(data->irq_name), "%s_echo", data->name);
+    
     // 동기화 객체 초기화
-    mutex_init(&sensor_dev->lock);
-    init_waitqueue_head(&sensor_dev->wait_queue);
-    atomic_set(&sensor_dev->measurement_ready, 0);
-    sensor_dev->state = SENSOR_IDLE;
-    sensor_dev->last_trigger_time = jiffies - msecs_to_jiffies(100);
+    mutex_init(&data->lock);
+    init_waitqueue_head(&data->wait_queue);
+    init_waitqueue_head(&data->ring_wait);
+    atomic_set(&data->state, SENSOR_IDLE);
+    data->last_trigger = ktime_sub_ms(ktime_get(), MIN_INTERVAL_MS);
+    
+    // mmap 링 버퍼 할당 (사용자 공간 매핑용, 0으로 초기화됨)
+    data->ring_size = PAGE_ALIGN(sizeof(struct hc_sr04p_ring)) +
+                      PAGE_ALIGN(SAMPLE_RING_ENTRIES * sizeof(struct hc_sr04p_sample));
+    data->ring = vmalloc_user(data->ring_size);
+    if (!data->ring) {
+        ret = -ENOMEM;
+        goto err_free_mem;
+    }
+    data->ring->entries = SAMPLE_RING_ENTRIES;
+    data->ring->data_offset = PAGE_ALIGN(sizeof(struct hc_sr04p_ring));
+    data->ring_data = (void *)data->ring + data->ring->data_offset;
+    
+    // 연속 측정 모드 초기화
+    spin_lock_init(&data->sample_lock);
+    seqcount_spinlock_init(&data->last_seqcount, &data->sample_lock);
+    INIT_KFIFO(data->samples);
+    INIT_KFIFO(data->events);
+    hrtimer_init(&data->trigger_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL_HARD);
+    data->trigger_timer.function = trigger_timer_fn;
+    hrtimer_init(&data->deadline_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    data->deadline_timer.function = deadline_timer_fn;
+    INIT_WORK(&data->trigger_work, trigger_work_fn);
     
     // GPIO 설정
-    ret = gpio_request_one(TRIGGER_PIN, GPIOF_OUT_INIT_LOW, "HC-SR04P Trigger");
+    ret = gpio_request_one(data->trigger_pin, GPIOF_OUT_INIT_LOW, "HC-SR04P Trigger");
     if (ret) {
-        pr_err("[HC-SR04P]: Cannot request trigger GPIO %d\n", TRIGGER_PIN);
-        goto err_free_mem;
+        pr_err("[HC-SR04P]: Cannot request trigger GPIO %d\n", data->trigger_pin);
+        goto err_free_ring;
     }
     
-    ret = gpio_request_one(ECHO_PIN, GPIOF_IN, "HC-SR04P Echo");
+    ret = gpio_request_one(data->echo_pin, GPIOF_IN, "HC-SR04P Echo");
     if (ret) {
-        pr_err("[HC-SR04P]: Cannot request echo GPIO %d\n", ECHO_PIN);
+        pr_err("[HC-SR04P]: Cannot request echo GPIO %d\n", data->echo_pin);
         goto err_free_trigger;
     }
     
+    data->trigger_cansleep = gpio_cansleep(data->trigger_pin);
+    if (data->trigger_cansleep)
+        pr_info("[HC-SR04P]: Trigger GPIO %d can sleep, pulse generated from a workqueue\n",
+                data->trigger_pin);
+    
     // 인터럽트 설정
-    sensor_dev->irq_number = gpio_to_irq(ECHO_PIN);
-    ret = request_irq(sensor_dev->irq_number, echo_irq_handler,
-                     IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING,
-                     "hc_sr04p_echo", sensor_dev);
+    data->irq_number = gpio_to_irq(data->echo_pin);
+    // IRQF_ONESHOT: 상반부는 PREEMPT_RT에서도 강제 스레드화되지 않고 hardirq에서 실행
+    ret = request_threaded_irq(data->irq_number, echo_irq_handler, echo_irq_thread,
+                               IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING | IRQF_ONESHOT,
+                               data->irq_name, data);
     if (ret) {
-        pr_err("[HC-SR04P]: Cannot request IRQ %d\n", sensor_dev->irq_number);
+        pr_err("[HC-SR04P]: Cannot request IRQ %d\n", data->irq_number);
         goto err_free_echo;
     }
     
     // 문자 디바이스 등록
-    ret = alloc_chrdev_region(&sensor_dev->dev_number, 0, 1, DEVICE_NAME);
+    cdev_init(&data->char_dev, &fops);
+    ret = cdev_add(&data->char_dev, data->dev_number, 1);
     if (ret < 0) {
-        pr_err("[HC-SR04P]: Cannot allocate major number\n");
+        pr_err("[HC-SR04P]: Cannot add device\n");
         goto err_free_irq;
     }
     
-    cdev_init(&sensor_dev->char_dev, &fops);
-    ret = cdev_add(&sensor_dev->char_dev, sensor_dev->dev_number, 1);
+    // 디바이스 파일 생성
+    data->dev_device = device_create_with_groups(
+        sensor_class,
+        NULL,
+        data->dev_number,
+        data,
+        hc_sr04p_groups,
+        "%s",
+        data->name
+    );
+    
+    if (IS_ERR(data->dev_device)) {
+        pr_err("[HC-SR04P]: Cannot create device\n");
+        ret = PTR_ERR(data->dev_device);
+        goto err_del_cdev;
+    }
+    
+    // debugfs 통계 (/sys/kernel/debug/hc_sr04p/<이름>/, 실패해도 드라이버 동작에는 영향 없음)
+    data->debug_dir = debugfs_create_dir(data->name, debug_root);
+    debugfs_create_file("stats", 0444, data->debug_dir, data, &stats_fops);
+    debugfs_create_file("histograms", 0444, data->debug_dir, data, &histograms_fops);
+    debugfs_create_file_unsafe("reset", 0200, data->debug_dir, data, &stats_reset_fops);
+    
+    sensor_iio_register(data);
+    
+    sensors[index] = data;
+    pr_info("[HC-SR04P]: /dev/%s: trigger GPIO %d, echo GPIO %d\n",
+            data->name, data->trigger_pin, data->echo_pin);
+    return 0;
+    
+    // 에러 처리
+err_del_cdev:
+    cdev_del(&data->char_dev);
+err_free_irq:
+    free_irq(data->irq_number, data);
+err_free_echo:
+    gpio_free(data->echo_pin);
+err_free_trigger:
+    gpio_free(data->trigger_pin);
+err_free_ring:
+    vfree(data->ring);
+err_free_mem:
+    kfree(data);
+    return ret;
+}
+
+// 센서 하나 해제
+static void sensor_remove(struct sensor_data *data) {
+    sensor_iio_unregister(data);
+    debugfs_remove_recursive(data->debug_dir);
+    device_destroy(sensor_class, data->dev_number);
+    cdev_del(&data->char_dev);
+    free_irq(data->irq_number, data);
+    cancel_work_sync(&data->trigger_work);
+    hrtimer_cancel(&data->trigger_timer);
+    hrtimer_cancel(&data->deadline_timer);
+    gpio_free(data->echo_pin);
+    gpio_free(data->trigger_pin);
+    vfree(data->ring);
+    kfree(data);
+}
+
+// 모듈 초기화 (수정된 부분 - 권한 설정 추가)
+static int __init hc_sr04p_init(void) {
+    unsigned long flags;
+    unsigned int i;
+    int ret;
+    
+    pr_info("[HC-SR04P]: Initializing ultrasonic sensor driver\n");
+    
+    if (num_trigger_pins != num_echo_pins) {
+        pr_err("[HC-SR04P]: trigger_pins and echo_pins must have the same length\n");
+        return -EINVAL;
+    }
+    num_sensors = num_trigger_pins;
+    
+    if (sample_hz > SAMPLE_HZ_MAX) {
+        pr_warn("[HC-SR04P]: sample_hz %u too high, clamping to %d\n", sample_hz, SAMPLE_HZ_MAX);
+        sample_hz = SAMPLE_HZ_MAX;
+    }
+    
+    // 문자 디바이스 번호 할당 (센서마다 minor 하나)
+    ret = alloc_chrdev_region(&sensor_devt, 0, num_sensors, DEVICE_NAME);
     if (ret < 0) {
-        pr_err("[HC-SR04P]: Cannot add device\n");
-        goto err_unreg_chrdev;
+        pr_err("[HC-SR04P]: Cannot allocate major number\n");
+        return ret;
     }
     
     // *** 수정: 클래스 생성 및 권한 설정 콜백 등록 ***
-    sensor_dev->dev_class = class_create(CLASS_NAME);
-    if (IS_ERR(sensor_dev->dev_class)) {
+    sensor_class = class_create(CLASS_NAME);
+    if (IS_ERR(sensor_class)) {
         pr_err("[HC-SR04P]: Cannot create class\n");
-        ret = PTR_ERR(sensor_dev->dev_class);
-        goto err_del_cdev;
+        ret = PTR_ERR(sensor_class);
+        goto err_unreg_chrdev;
     }
     
     // *** 추가: 권한 자동 설정을 위한 uevent 콜백 등록 ***
-    sensor_dev->dev_class->dev_uevent = hc_sr04p_dev_uevent;
+    sensor_class->dev_uevent = hc_sr04p_dev_uevent;
     
-    // 디바이스 파일 생성
-    sensor_dev->dev_device = device_create(
-        sensor_dev->dev_class,
-        NULL,
-        sensor_dev->dev_number,
-        NULL,
-        DEVICE_NAME
-    );
+    // 트리거 스케줄러 초기화
+    spin_lock_init(&sched.lock);
+    hrtimer_init(&sched.timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+    sched.timer.function = sched_timer_fn;
+    sched.last_trigger = ktime_sub_ms(ktime_get(), stagger_ms);
     
-    if (IS_ERR(sensor_dev->dev_device)) {
-        pr_err("[HC-SR04P]: Cannot create device\n");
-        ret = PTR_ERR(sensor_dev->dev_device);
-        goto err_destroy_class;
+    debug_root = debugfs_create_dir(DEVICE_NAME, NULL);
+    
+    for (i = 0; i < num_sensors; i++) {
+        ret = sensor_probe(i);
+        if (ret)
+            goto err_remove_sensors;
+    }
+    
+    // 연속 측정 시작
+    if (sample_hz) {
+        sched.period = ns_to_ktime(NSEC_PER_SEC / sample_hz);
+        
+        spin_lock_irqsave(&sched.lock, flags);
+        for (i = 0; i < num_sensors; i++)
+            sensors[i]->next_due = ktime_get();
+        sched_run_locked();
+        spin_unlock_irqrestore(&sched.lock, flags);
+        
+        pr_info("[HC-SR04P]: Free-running mode at %u Hz per sensor\n", sample_hz);
     }
     
-    pr_info("[HC-SR04P]: Device registered successfully. Device: /dev/%s (auto-permission: 0666)\n", DEVICE_NAME);
+    pr_info("[HC-SR04P]: %u sensor(s) registered successfully (auto-permission: 0666)\n", num_sensors);
     return 0;
     
     // 에러 처리
-err_destroy_class:
-    class_destroy(sensor_dev->dev_class);
-err_del_cdev:
-    cdev_del(&sensor_dev->char_dev);
+err_remove_sensors:
+    spin_lock_irqsave(&sched.lock, flags);
+    sched.stopping = true;
+    spin_unlock_irqrestore(&sched.lock, flags);
+    hrtimer_cancel(&sched.timer);
+    while (i--)
+        sensor_remove(sensors[i]);
+    debugfs_remove_recursive(debug_root);
+    class_destroy(sensor_class);
 err_unreg_chrdev:
-    unregister_chrdev_region(sensor_dev->dev_number, 1);
-err_free_irq:
-    free_irq(sensor_dev->irq_number, sensor_dev);
-err_free_echo:
-    gpio_free(ECHO_PIN);
-err_free_trigger:
-    gpio_free(TRIGGER_PIN);
-err_free_mem:
-    kfree(sensor_dev);
+    unregister_chrdev_region(sensor_devt, num_sensors);
     return ret;
 }
 
 // 모듈 해제
 static void __exit hc_sr04p_exit(void) {
+    unsigned long flags;
+    unsigned int i;
+    
     pr_info("[HC-SR04P]: Exiting ultrasonic sensor driver\n");
     
-    device_destroy(sensor_dev->dev_class, sensor_dev->dev_number);
-    class_destroy(sensor_dev->dev_class);
-    cdev_del(&sensor_dev->char_dev);
-    unregister_chrdev_region(sensor_dev->dev_number, 1);
-    free_irq(sensor_dev->irq_number, sensor_dev);
-    gpio_free(ECHO_PIN);
-    gpio_free(TRIGGER_PIN);
-    kfree(sensor_dev);
+    // 스케줄러를 먼저 멈춰서 해제 중인 센서가 트리거되지 않도록 함
+    spin_lock_irqsave(&sched.lock, flags);
+    sched.stopping = true;
+    spin_unlock_irqrestore(&sched.lock, flags);
+    hrtimer_cancel(&sched.timer);
+    
+    for (i = 0; i < num_sensors; i++)
+        sensor_remove(sensors[i]);
+    
+    debugfs_remove_recursive(debug_root);
+    class_destroy(sensor_class);
+    unregister_chrdev_region(sensor_devt, num_sensors);
 }
 
 module_init(hc_sr04p_init);
@@ -0,0 +1,119 @@
+// drivers/ultrasonic/hc_sr04p_trace.h
+// HC-SR04P 트리거/에코/읽기 경로 tracepoint (/sys/kernel/tracing/events/hc_sr04p/)
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM hc_sr04p
+
+#if !defined(_HC_SR04P_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _HC_SR04P_TRACE_H
+
+#include <linux/tracepoint.h>
+
+// 트리거 펄스 출력
+TRACE_EVENT(hc_sr04p_trigger,
+    TP_PROTO(unsigned int sensor),
+    TP_ARGS(sensor),
+    TP_STRUCT__entry(
+        __field(unsigned int, sensor)
+    ),
+    TP_fast_assign(
+        __entry->sensor = sensor;
+    ),
+    TP_printk("sensor=%u", __entry->sensor)
+);
+
+// ECHO rising edge (hardirq)
+TRACE_EVENT(hc_sr04p_rising,
+    TP_PROTO(unsigned int sensor),
+    TP_ARGS(sensor),
+    TP_STRUCT__entry(
+        __field(unsigned int, sensor)
+    ),
+    TP_fast_assign(
+        __entry->sensor = sensor;
+    ),
+    TP_printk("sensor=%u", __entry->sensor)
+);
+
+// ECHO falling edge 처리 완료 (IRQ 스레드)
+TRACE_EVENT(hc_sr04p_falling,
+    TP_PROTO(unsigned int sensor, s64 width_ns, int raw_mm, int distance_mm),
+    TP_ARGS(sensor, width_ns, raw_mm, distance_mm),
+    TP_STRUCT__entry(
+        __field(unsigned int, sensor)
+        __field(s64, width_ns)
+        __field(int, raw_mm)
+        __field(int, distance_mm)
+    ),
+    TP_fast_assign(
+        __entry->sensor = sensor;
+        __entry->width_ns = width_ns;
+        __entry->raw_mm = raw_mm;
+        __entry->distance_mm = distance_mm;
+    ),
+    TP_printk("sensor=%u width_ns=%lld raw_mm=%d distance_mm=%d",
+              __entry->sensor, __entry->width_ns, __entry->raw_mm, __entry->distance_mm)
+);
+
+// 유효하지 않은 샘플 (범위 밖, 필터 제외, 타임아웃)
+TRACE_EVENT(hc_sr04p_rejected,
+    TP_PROTO(unsigned int sensor, u32 status, u32 seq),
+    TP_ARGS(sensor, status, seq),
+    TP_STRUCT__entry(
+        __field(unsigned int, sensor)
+        __field(u32, status)
+        __field(u32, seq)
+    ),
+    TP_fast_assign(
+        __entry->sensor = sensor;
+        __entry->status = status;
+        __entry->seq = seq;
+    ),
+    TP_printk("sensor=%u seq=%u status=%s", __entry->sensor, __entry->seq,
+              __print_symbolic(__entry->status,
+                               { HC_SR04P_STATUS_OUT_OF_RANGE, "out_of_range" },
+                               { HC_SR04P_STATUS_NO_ECHO, "no_echo" },
+                               { HC_SR04P_STATUS_REJECTED, "filter_rejected" },
+                               { HC_SR04P_STATUS_ECHO_STUCK, "echo_stuck" }))
+);
+
+// 결과를 기다리던 읽기 요청이 깨어남
+TRACE_EVENT(hc_sr04p_reader_woken,
+    TP_PROTO(unsigned int sensor, u32 seq),
+    TP_ARGS(sensor, seq),
+    TP_STRUCT__entry(
+        __field(unsigned int, sensor)
+        __field(u32, seq)
+    ),
+    TP_fast_assign(
+        __entry->sensor = sensor;
+        __entry->seq = seq;
+    ),
+    TP_printk("sensor=%u seq=%u", __entry->sensor, __entry->seq)
+);
+
+// device_read() 반환
+TRACE_EVENT(hc_sr04p_read_return,
+    TP_PROTO(unsigned int sensor, ssize_t ret, s64 latency_ns),
+    TP_ARGS(sensor, ret, latency_ns),
+    TP_STRUCT__entry(
+        __field(unsigned int, sensor)
+        __field(ssize_t, ret)
+        __field(s64, latency_ns)
+    ),
+    TP_fast_assign(
+        __entry->sensor = sensor;
+        __entry->ret = ret;
+        __entry->latency_ns = latency_ns;
+    ),
+    TP_printk("sensor=%u ret=%zd latency_ns=%lld",
+              __entry->sensor, __entry->ret, __entry->latency_ns)
+);
+
+#endif // _HC_SR04P_TRACE_H
+
+// 커널 트리 밖에서 빌드하므로 이 디렉터리에서 다시 포함 (Makefile의 -I$(src))
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE hc_sr04p_trace
+#include <trace/define_trace.h>
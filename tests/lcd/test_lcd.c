@@ -4,7 +4,10 @@
 #include <string.h>
 
 // 실제 드라이버 헤더는 커널 의존성 때문에 직접 포함하지 않고
-// 테스트용 함수들만 간단히 작성
+// 테스트용 함수들만 간단히 작성 (I2C 인코딩은 드라이버와 같은 헤더 사용)
+#include "../../drivers/lcd/lcd1602_encode.h"
+#include "../../drivers/lcd/lcd1602_shadow.h"
+#include "../../drivers/lcd/lcd1602_glyph.h"
 typedef struct {
     int cursor_col;
     int cursor_row;
@@ -43,6 +46,106 @@ int test_line_wrap(void) {
     return 0;
 }
 
+int test_nibble_encoding(void) {
+    unsigned char buf[2 * LCD1602_BYTE_BYTES];
+    const struct lcd1602_op ops[] = { { 'A', LCD1602_RS }, { 0x01, 0 } };
+    // 'A' (0x41) 데이터, 백라이트 켬: 상위 니블 0x4, 하위 니블 0x1 순서, EN 펄스 포함
+    const unsigned char data_a[] = { 0x49, 0x4D, 0x49, 0x19, 0x1D, 0x19 };
+    // CLEAR (0x01) 명령, 백라이트 끔
+    const unsigned char cmd_clear[] = { 0x00, 0x04, 0x00, 0x10, 0x14, 0x10 };
+    
+    assert(lcd1602_encode_byte(buf, 'A', LCD1602_RS, 1) == LCD1602_BYTE_BYTES);
+    assert(memcmp(buf, data_a, sizeof(data_a)) == 0);
+    
+    assert(lcd1602_encode_byte(buf, 0x01, 0, 0) == LCD1602_BYTE_BYTES);
+    assert(memcmp(buf, cmd_clear, sizeof(cmd_clear)) == 0);
+    
+    // 여러 바이트를 한 전송 버퍼로 연속 인코딩 (백라이트 켬)
+    assert(lcd1602_encode_ops(buf, ops, 2, 1) == 2 * LCD1602_BYTE_BYTES);
+    assert(memcmp(buf, data_a, sizeof(data_a)) == 0);
+    assert(buf[LCD1602_BYTE_BYTES] == (cmd_clear[0] | LCD1602_BACKLIGHT));
+    assert(buf[2 * LCD1602_BYTE_BYTES - 2] == (cmd_clear[4] | LCD1602_BACKLIGHT));
+    
+    printf("✓ Nibble encoding test passed\n");
+    return 0;
+}
+
+int test_shadow_diff(void) {
+    unsigned char shadow[LCD1602_CELLS], frame[LCD1602_CELLS];
+    struct lcd1602_op ops[LCD1602_DIFF_MAX_OPS];
+    unsigned int n;
+    int ac;
+    
+    memset(shadow, ' ', sizeof(shadow));
+    memcpy(frame, shadow, sizeof(frame));
+    
+    // 바뀐 칸이 없으면 아무것도 보내지 않음
+    ac = 0;
+    assert(lcd1602_diff(ops, shadow, frame, 0, &ac) == 0);
+    assert(ac == 0);
+    
+    // 1행 3~4칸, 2행 0칸 변경: 주소 명령은 각 구간 시작에만
+    frame[3] = '1';
+    frame[4] = '2';
+    frame[LCD1602_COLS] = 'X';
+    n = lcd1602_diff(ops, shadow, frame, 0, &ac);
+    assert(n == 5);
+    assert(ops[0].control == 0 && ops[0].value == (LCD1602_CMD_SET_DDRAM_ADDR | 0x03));
+    assert(ops[1].control == LCD1602_RS && ops[1].value == '1');
+    assert(ops[2].control == LCD1602_RS && ops[2].value == '2');
+    assert(ops[3].control == 0 && ops[3].value == (LCD1602_CMD_SET_DDRAM_ADDR | 0x40));
+    assert(ops[4].control == LCD1602_RS && ops[4].value == 'X');
+    assert(ac == 0x41);
+    
+    // 주소 카운터가 이미 그 칸에 있으면 주소 명령 생략
+    memcpy(shadow, frame, sizeof(shadow));
+    frame[LCD1602_COLS + 1] = 'Y';
+    assert(lcd1602_diff(ops, shadow, frame, 0, &ac) == 1);
+    
+    // 행 끝 다음 칸(2행 처음)으로는 주소 명령이 필요
+    memcpy(shadow, frame, sizeof(shadow));
+    frame[LCD1602_COLS - 1] = 'a';
+    frame[LCD1602_COLS] = 'b';
+    ac = -1;
+    assert(lcd1602_diff(ops, shadow, frame, 0, &ac) == 4);
+    
+    // full이면 변경 여부와 상관없이 전체 (행마다 주소 명령 1개)
+    ac = -1;
+    assert(lcd1602_diff(ops, frame, frame, 1, &ac) == LCD1602_CELLS + LCD1602_ROWS);
+    
+    printf("✓ Shadow DDRAM diff test passed\n");
+    return 0;
+}
+
+int test_cgram_lru(void) {
+    struct lcd1602_cgram cgram;
+    unsigned int key, tick = 1;
+    int load;
+    
+    lcd1602_cgram_reset(&cgram);
+    
+    // 빈 슬롯부터 차례로 사용, 처음 한 번만 업로드
+    for (key = 1; key <= LCD1602_CGRAM_SLOTS; key++) {
+        assert(lcd1602_cgram_slot(&cgram, key, 0, tick++, &load) == (int)key - 1);
+        assert(load == 1);
+    }
+    assert(lcd1602_cgram_slot(&cgram, 3, 0, tick++, &load) == 2);
+    assert(load == 0);
+    
+    // 가득 차면 가장 오래 안 쓰인 슬롯(key 1 → 슬롯 0)을 교체
+    assert(lcd1602_cgram_slot(&cgram, 100, 0, tick++, &load) == 0);
+    assert(load == 1);
+    
+    // 이번 화면이 쓰는 슬롯(pinned)은 교체하지 않음: 다음 LRU는 슬롯 1, 고정하면 슬롯 3
+    assert(lcd1602_cgram_slot(&cgram, 101, 1u << 1, tick++, &load) == 3);
+    
+    // 8개 모두 고정이면 실패
+    assert(lcd1602_cgram_slot(&cgram, 102, 0xFF, tick++, &load) == -1);
+    
+    printf("✓ CGRAM glyph LRU test passed\n");
+    return 0;
+}
+
 int test_backlight_blink(void) {
     printf("🔆 Testing: Backlight control... ");
     
@@ -70,6 +173,9 @@ int main(void) {
     
     // test_cursor_update();
     // test_line_wrap();
+    test_nibble_encoding();
+    test_shadow_diff();
+    test_cgram_lru();
     test_backlight_blink();
     printf("All tests passed! ✅\n");
     return 0;
@@ -0,0 +1,37 @@
+// tests/ultrasonic/bench_conv.c
+// 펄스 폭 → 거리 변환 호스트 마이크로벤치마크 (드라이버와 같은 hc_sr04p_conv.h 사용)
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <time.h>
+
+#include "../../drivers/ultrasonic/hc_sr04p_conv.h"
+
+#define ITERATIONS 50000000LL
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(void) {
+    volatile int sink = 0;
+    long long i, pulse_ns;
+    double start, elapsed;
+
+    printf("🚀 HC-SR04P conversion benchmark\n");
+
+    // 유효 범위 안팎을 모두 지나도록 펄스 폭을 바꿔 가며 변환
+    start = now_ns();
+    for (i = 0; i < ITERATIONS; i++) {
+        pulse_ns = (i * 7919) % 40000000LL;
+        sink += hc_sr04p_pulse_to_mm(pulse_ns);
+    }
+    elapsed = now_ns() - start;
+
+    printf("📊 hc_sr04p_pulse_to_mm: %.2f ns/conversion (%lld conversions)\n",
+           elapsed / ITERATIONS, ITERATIONS);
+    (void)sink;
+    return 0;
+}
@@ -0,0 +1,70 @@
+#!/bin/sh
+# tests/ultrasonic/run_sim.sh
+# gpio-sim 칩(라인 0: TRIGGER, 라인 1: ECHO)을 만들고 hc_sr04p_driver.ko를 연결해서
+# sim_ultrasonic을 실행 (root, gpio-sim 모듈, configfs/tracefs/debugfs 필요)
+# gpio-sim 칩은 슬립 가능한 칩이라 드라이버는 트리거 펄스를 워크큐에서 생성함 (dmesg에 표시)
+# 인자를 주면 테스트 대신 에코 응답기만 띄우고 그 명령을 실행 (예: run_sim.sh ../../bench/door_bench)
+set -e
+
+SCRIPT_DIR=$(cd "$(dirname "$0")" && pwd)
+MODULE=${MODULE:-$SCRIPT_DIR/../../drivers/ultrasonic/hc_sr04p_driver.ko}
+CONFIGFS=/sys/kernel/config/gpio-sim
+SIM=$CONFIGFS/hc_sr04p_test
+TRACEFS=/sys/kernel/tracing
+
+RESPONDER=
+
+cleanup() {
+    [ -n "$RESPONDER" ] && kill "$RESPONDER" 2>/dev/null || true
+    rmmod hc_sr04p_driver 2>/dev/null || true
+    if [ -d "$SIM" ]; then
+        echo 0 > "$SIM/live" 2>/dev/null || true
+        rmdir "$SIM/bank0/line0" "$SIM/bank0/line1" 2>/dev/null || true
+        rmdir "$SIM/bank0" "$SIM" 2>/dev/null || true
+    fi
+}
+trap cleanup EXIT
+
+if [ ! -f "$MODULE" ]; then
+    echo "Driver module not found: $MODULE (build drivers/ultrasonic first)" >&2
+    exit 1
+fi
+
+modprobe gpio-sim
+mountpoint -q /sys/kernel/config || mount -t configfs none /sys/kernel/config
+mountpoint -q /sys/kernel/debug || mount -t debugfs none /sys/kernel/debug
+[ -d "$TRACEFS/events" ] || TRACEFS=/sys/kernel/debug/tracing
+
+# 시뮬레이션 칩 생성
+mkdir "$SIM" "$SIM/bank0"
+echo 2 > "$SIM/bank0/num_lines"
+mkdir "$SIM/bank0/line0" "$SIM/bank0/line1"
+echo trigger > "$SIM/bank0/line0/name"
+echo echo > "$SIM/bank0/line1/name"
+echo 1 > "$SIM/live"
+
+CHIP=$(cat "$SIM/bank0/chip_name")
+DEV=$(cat "$SIM/dev_name")
+
+# 드라이버는 전역 GPIO 번호를 쓰므로 칩의 base를 찾음
+# (debugfs 형식: "gpiochip2: GPIOs 560-561, parent: platform/gpio-sim.0, ...")
+BASE=$(sed -n "s/^$CHIP: [Gg][Pp][Ii][Oo]s \([0-9]*\)-.*/\1/p" /sys/kernel/debug/gpio)
+if [ -z "$BASE" ]; then
+    echo "Cannot find GPIO base of $CHIP" >&2
+    exit 1
+fi
+
+insmod "$MODULE" trigger_pins="$BASE" echo_pins="$((BASE + 1))"
+udevadm settle 2>/dev/null || sleep 1
+
+PULL="/sys/devices/platform/$DEV/$CHIP/sim_gpio1/pull"
+
+if [ $# -eq 0 ]; then
+    "$SCRIPT_DIR/sim_ultrasonic" /dev/hc_sr04p "$PULL" "$TRACEFS"
+    exit
+fi
+
+"$SCRIPT_DIR/sim_ultrasonic" --respond "$PULL" "$TRACEFS" &
+RESPONDER=$!
+sleep 1
+"$@"
@@ -0,0 +1,497 @@
+// tests/ultrasonic/sim_ultrasonic.c
+// gpio-sim 기반 드라이버 테스트 (라즈베리파이 없이 실제 hc_sr04p_driver.ko를 검증)
+// run_sim.sh가 gpio-sim 칩을 만들고 드라이버를 그 라인에 연결한 뒤 실행함
+//
+// 에코 응답기: tracefs의 hc_sr04p_trigger 이벤트를 보고, 설정된 지연/폭만큼
+// 시뮬레이션 에코 라인의 pull을 올렸다 내려서 에코 펄스를 만듦
+// --respond 모드: 테스트 없이 고정 폭(1m) 에코만 계속 응답 (bench/run_sim.sh에서 사용)
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+
+#include "../../drivers/ultrasonic/hc_sr04p.h"
+#include "../../drivers/ultrasonic/hc_sr04p_conv.h"
+
+#define ECHO_RISE_DELAY_US  200     // 트리거 → 에코 시작 (실제 센서는 약 200~500μs)
+#define ECHO_STUCK          -1      // rising edge 후 falling edge 없음
+#define MAX_TRIGGERS        1024
+#define CONCURRENT_READERS  4
+#define LATENCY_SAMPLES     50
+#define RESPOND_WIDTH_US    5800    // --respond 모드 에코 폭 (1000mm)
+
+static const char *device_path;
+static const char *echo_pull_path;
+static const char *tracefs_path = "/sys/kernel/tracing";
+
+// 응답기 설정과 트리거 기록 (lock으로 보호)
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static int echo_width_us;           // 0이면 에코 없음
+static double trigger_times[MAX_TRIGGERS];  // 커널 trace 타임스탬프 (s)
+static int trigger_count;
+
+// 테스트 카운터
+static int tests_passed = 0;
+static int tests_total = 0;
+
+#define TEST_START(name) do { \
+    printf("🧪 Testing: %s... ", name); \
+    fflush(stdout); \
+    tests_total++; \
+} while(0)
+
+#define TEST_PASS() do { \
+    printf("✅ PASSED\n"); \
+    tests_passed++; \
+} while(0)
+
+#define TEST_FAIL(msg) do { \
+    printf("❌ FAILED: %s\n", msg); \
+    return -1; \
+} while(0)
+
+static double now_ms(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void sleep_us(long us) {
+    struct timespec ts = { us / 1000000, (us % 1000000) * 1000 };
+
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, NULL);
+}
+
+static int write_file(const char *dir, const char *name, const char *value) {
+    char path[256];
+    int fd, ret;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    fd = open(path, O_WRONLY);
+    if (fd < 0)
+        return -1;
+    ret = write(fd, value, strlen(value)) < 0 ? -1 : 0;
+    close(fd);
+    return ret;
+}
+
+static void set_echo(int fd, int high) {
+    const char *value = high ? "pull-up" : "pull-down";
+
+    if (pwrite(fd, value, strlen(value), 0) < 0)
+        perror("echo pull");
+}
+
+static void set_echo_width(int width_us) {
+    pthread_mutex_lock(&lock);
+    echo_width_us = width_us;
+    pthread_mutex_unlock(&lock);
+}
+
+static int reset_triggers(void) {
+    int count;
+
+    pthread_mutex_lock(&lock);
+    count = trigger_count;
+    trigger_count = 0;
+    pthread_mutex_unlock(&lock);
+    return count;
+}
+
+// trace_pipe 한 줄에서 첫 번째 센서의 트리거 이벤트 타임스탬프 추출
+// 형식: "  <task>-<pid>  [000] d.h1.  1234.567890: hc_sr04p_trigger: sensor=0"
+static int parse_trigger(const char *line, double *ts) {
+    const char *event = strstr(line, " hc_sr04p_trigger: sensor=0");
+    const char *p;
+
+    if (!event || event - line < 2)
+        return -1;
+
+    p = event - 1;  // ':'
+    while (p > line && (p[-1] == '.' || (p[-1] >= '0' && p[-1] <= '9')))
+        p--;
+
+    *ts = strtod(p, NULL);
+    return 0;
+}
+
+// 에코 응답기 스레드
+static void *responder(void *arg) {
+    char path[256], line[512];
+    FILE *pipe;
+    int echo_fd, width;
+    double ts;
+
+    (void)arg;
+
+    echo_fd = open(echo_pull_path, O_WRONLY);
+    snprintf(path, sizeof(path), "%s/trace_pipe", tracefs_path);
+    pipe = fopen(path, "r");
+    if (echo_fd < 0 || !pipe) {
+        perror("responder");
+        exit(1);
+    }
+
+    set_echo(echo_fd, 0);
+
+    while (fgets(line, sizeof(line), pipe)) {
+        if (parse_trigger(line, &ts))
+            continue;
+
+        pthread_mutex_lock(&lock);
+        if (trigger_count < MAX_TRIGGERS)
+            trigger_times[trigger_count++] = ts;
+        width = echo_width_us;
+        pthread_mutex_unlock(&lock);
+
+        if (!width)
+            continue;
+
+        sleep_us(ECHO_RISE_DELAY_US);
+        set_echo(echo_fd, 1);
+        if (width == ECHO_STUCK)
+            continue;   // 테스트가 직접 내림
+        sleep_us(width);
+        set_echo(echo_fd, 0);
+    }
+
+    return NULL;
+}
+
+// 텍스트 모드 읽기 한 번 (pread로 매번 오프셋 0부터)
+static int read_text(int fd, char *buf, size_t len) {
+    ssize_t n = pread(fd, buf, len - 1, 0);
+
+    if (n < 0)
+        return -errno;
+    buf[n] = '\0';
+    return 0;
+}
+
+// 펄스 폭 → 거리 변환 검증
+int test_conversion(void) {
+    static const int widths_us[] = { 580, 2900, 5800, 11600, 23200 };
+    char buf[32], msg[128];
+    int fd, i, expected, got, tolerance;
+
+    TEST_START("Pulse width to distance conversion");
+
+    fd = open(device_path, O_RDONLY);
+    if (fd < 0)
+        TEST_FAIL("Cannot open device");
+
+    for (i = 0; i < (int)(sizeof(widths_us) / sizeof(widths_us[0])); i++) {
+        set_echo_width(widths_us[i]);
+        sleep_us(80000);  // 직전 결과를 공유하지 않도록 최소 간격 이상 대기
+
+        if (read_text(fd, buf, sizeof(buf)) || sscanf(buf, "%d", &got) != 1) {
+            close(fd);
+            TEST_FAIL("Read failed");
+        }
+
+        // 사용자 공간 응답기의 타이밍 오차 (수십 μs) 허용
+        expected = hc_sr04p_pulse_to_mm(widths_us[i] * 1000LL);
+        tolerance = 20 + expected / 20;
+        if (abs(got - expected) > tolerance) {
+            close(fd);
+            snprintf(msg, sizeof(msg), "%dus: expected %dmm, got %dmm", widths_us[i], expected, got);
+            TEST_FAIL(msg);
+        }
+    }
+
+    close(fd);
+    TEST_PASS();
+    return 0;
+}
+
+// 에코 유실 시 타임아웃 (2초가 아니라 에코 제한 시간 안에 오류 반환)
+int test_timeouts(void) {
+    char buf[32], msg[128];
+    double start, elapsed;
+    int fd, echo_fd, i;
+
+    TEST_START("Lost echo and stuck echo timeouts");
+
+    fd = open(device_path, O_RDONLY);
+    echo_fd = open(echo_pull_path, O_WRONLY);
+    if (fd < 0 || echo_fd < 0)
+        TEST_FAIL("Cannot open device or echo line");
+
+    for (i = 0; i < 2; i++) {
+        set_echo_width(i == 0 ? 0 : ECHO_STUCK);
+        sleep_us(80000);
+
+        start = now_ms();
+        if (read_text(fd, buf, sizeof(buf))) {
+            close(fd);
+            close(echo_fd);
+            TEST_FAIL("Read failed");
+        }
+        elapsed = now_ms() - start;
+        set_echo(echo_fd, 0);
+
+        if (strcmp(buf, "ERROR\n") != 0 || elapsed > 150.0) {
+            close(fd);
+            close(echo_fd);
+            snprintf(msg, sizeof(msg), "%s: got '%.*s' after %.1f ms",
+                     i == 0 ? "no echo" : "stuck echo", (int)strcspn(buf, "\n"), buf, elapsed);
+            TEST_FAIL(msg);
+        }
+    }
+
+    set_echo_width(580);
+    close(fd);
+    close(echo_fd);
+    TEST_PASS();
+    return 0;
+}
+
+// 연속 읽기에서도 트리거 간격이 60ms 이상인지
+int test_min_interval(void) {
+    struct hc_sr04p_sample sample;
+    double min_gap = 1.0;
+    char msg[128];
+    int fd, i, count;
+
+    TEST_START("Minimum trigger interval");
+
+    fd = open(device_path, O_RDONLY);
+    if (fd < 0 || ioctl(fd, HC_SR04P_IOC_SET_FORMAT, HC_SR04P_FMT_BINARY))
+        TEST_FAIL("Cannot open device in binary mode");
+
+    set_echo_width(580);
+    sleep_us(80000);
+    reset_triggers();
+
+    for (i = 0; i < 20; i++) {
+        if (read(fd, &sample, sizeof(sample)) != sizeof(sample)) {
+            close(fd);
+            TEST_FAIL("Read failed");
+        }
+    }
+    close(fd);
+
+    sleep_us(50000);  // 응답기가 마지막 트리거 이벤트를 처리할 시간
+    pthread_mutex_lock(&lock);
+    count = trigger_count;
+    for (i = 1; i < count; i++) {
+        if (trigger_times[i] - trigger_times[i - 1] < min_gap)
+            min_gap = trigger_times[i] - trigger_times[i - 1];
+    }
+    pthread_mutex_unlock(&lock);
+
+    if (count < 2)
+        TEST_FAIL("Responder saw no triggers");
+
+    // trace 타임스탬프는 μs 단위
+    if (min_gap < 0.0599) {
+        snprintf(msg, sizeof(msg), "triggers %.3f ms apart", min_gap * 1000.0);
+        TEST_FAIL(msg);
+    }
+
+    TEST_PASS();
+    return 0;
+}
+
+static pthread_barrier_t reader_barrier;
+
+static void *concurrent_reader(void *arg) {
+    int *result = arg;
+    char buf[32];
+    int fd;
+
+    *result = -1;
+    fd = open(device_path, O_RDONLY);
+    pthread_barrier_wait(&reader_barrier);
+    if (fd < 0)
+        return NULL;
+
+    if (!read_text(fd, buf, sizeof(buf)))
+        sscanf(buf, "%d", result);
+    close(fd);
+    return NULL;
+}
+
+// 동시에 읽는 프로세스들은 측정 하나를 공유 (-EBUSY 없음, 추가 트리거 없음)
+int test_concurrent_readers(void) {
+    pthread_t threads[CONCURRENT_READERS];
+    int results[CONCURRENT_READERS];
+    char msg[128];
+    int i, triggers;
+
+    TEST_START("Concurrent readers share one measurement");
+
+    set_echo_width(2900);
+    sleep_us(80000);
+    reset_triggers();
+
+    pthread_barrier_init(&reader_barrier, NULL, CONCURRENT_READERS);
+    for (i = 0; i < CONCURRENT_READERS; i++)
+        pthread_create(&threads[i], NULL, concurrent_reader, &results[i]);
+    for (i = 0; i < CONCURRENT_READERS; i++)
+        pthread_join(threads[i], NULL);
+    pthread_barrier_destroy(&reader_barrier);
+
+    sleep_us(50000);
+    triggers = reset_triggers();
+
+    for (i = 0; i < CONCURRENT_READERS; i++) {
+        if (results[i] <= 0) {
+            snprintf(msg, sizeof(msg), "reader %d got no distance", i);
+            TEST_FAIL(msg);
+        }
+    }
+
+    if (triggers != 1) {
+        snprintf(msg, sizeof(msg), "%d readers caused %d triggers", CONCURRENT_READERS, triggers);
+        TEST_FAIL(msg);
+    }
+
+    TEST_PASS();
+    return 0;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+// 읽기 지연 측정 (결과 보고, 모든 읽기가 성공하면 통과)
+int report_read_latency(void) {
+    double latency[LATENCY_SAMPLES], start, total = 0;
+    char buf[32];
+    int fd, i;
+
+    TEST_START("Read latency");
+
+    fd = open(device_path, O_RDONLY);
+    if (fd < 0)
+        TEST_FAIL("Cannot open device");
+
+    set_echo_width(5800);
+    for (i = 0; i < LATENCY_SAMPLES; i++) {
+        sleep_us(70000);
+        start = now_ms();
+        if (read_text(fd, buf, sizeof(buf)) || !strcmp(buf, "ERROR\n")) {
+            close(fd);
+            TEST_FAIL("Read failed");
+        }
+        latency[i] = now_ms() - start;
+        total += latency[i];
+    }
+    close(fd);
+
+    qsort(latency, LATENCY_SAMPLES, sizeof(latency[0]), compare_double);
+    TEST_PASS();
+    printf("   📊 1m echo read latency: mean %.2f ms, p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+           total / LATENCY_SAMPLES, latency[LATENCY_SAMPLES / 2],
+           latency[LATENCY_SAMPLES * 99 / 100], latency[LATENCY_SAMPLES - 1]);
+    return 0;
+}
+
+// 최대 샘플링 속도 (60ms 최소 간격 기준 이론값 약 16Hz)
+int report_max_rate(void) {
+    struct hc_sr04p_sample sample;
+    double start, elapsed;
+    unsigned int last_seq = 0;
+    int fd, samples = 0;
+    char msg[128];
+
+    TEST_START("Maximum sample rate");
+
+    fd = open(device_path, O_RDONLY);
+    if (fd < 0 || ioctl(fd, HC_SR04P_IOC_SET_FORMAT, HC_SR04P_FMT_BINARY))
+        TEST_FAIL("Cannot open device in binary mode");
+
+    set_echo_width(580);
+    sleep_us(80000);
+
+    start = now_ms();
+    while ((elapsed = now_ms() - start) < 2000.0) {
+        if (read(fd, &sample, sizeof(sample)) != sizeof(sample)) {
+            close(fd);
+            TEST_FAIL("Read failed");
+        }
+        if (!samples || sample.seq != last_seq)
+            samples++;
+        last_seq = sample.seq;
+    }
+    close(fd);
+
+    if (samples * 1000.0 / elapsed < 12.0) {
+        snprintf(msg, sizeof(msg), "only %.1f samples/s", samples * 1000.0 / elapsed);
+        TEST_FAIL(msg);
+    }
+
+    TEST_PASS();
+    printf("   📊 Max sample rate: %.1f samples/s\n", samples * 1000.0 / elapsed);
+    return 0;
+}
+
+// 메인 테스트 함수
+int main(int argc, char **argv) {
+    pthread_t thread;
+    int respond_only = 0;
+
+    if (argc >= 3 && !strcmp(argv[1], "--respond")) {
+        respond_only = 1;
+    } else if (argc < 3) {
+        fprintf(stderr, "usage: %s <device> <echo pull attribute> [tracefs]\n"
+                        "       %s --respond <echo pull attribute> [tracefs]\n", argv[0], argv[0]);
+        return 2;
+    }
+    device_path = argv[1];
+    echo_pull_path = argv[2];
+    if (argc > 3)
+        tracefs_path = argv[3];
+
+    if (write_file(tracefs_path, "events/hc_sr04p/hc_sr04p_trigger/enable", "1") ||
+        write_file(tracefs_path, "tracing_on", "1")) {
+        fprintf(stderr, "Cannot enable hc_sr04p_trigger tracepoint in %s\n", tracefs_path);
+        return 2;
+    }
+
+    if (respond_only) {
+        echo_width_us = RESPOND_WIDTH_US;
+        responder(NULL);
+        return 0;
+    }
+
+    printf("🚀 Starting HC-SR04P gpio-sim Tests\n");
+    printf("===================================\n\n");
+
+    pthread_create(&thread, NULL, responder, NULL);
+    sleep_us(100000);
+
+    test_conversion();
+    test_timeouts();
+    test_min_interval();
+    test_concurrent_readers();
+    report_read_latency();
+    report_max_rate();
+
+    write_file(tracefs_path, "events/hc_sr04p/hc_sr04p_trigger/enable", "0");
+
+    // 결과 요약
+    printf("\n📊 Test Results Summary\n");
+    printf("=======================\n");
+    printf("Total tests: %d\n", tests_total);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_total - tests_passed);
+    
+    if (tests_passed == tests_total) {
+        printf("\n🎉 All gpio-sim tests passed!\n");
+        return 0;
+    } else {
+        printf("\n❌ Some tests failed. Please check the implementation.\n");
+        return 1;
+    }
+}
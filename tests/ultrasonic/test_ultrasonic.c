@@ -3,6 +3,10 @@
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
+
+#include "../../drivers/ultrasonic/hc_sr04p.h"
+#include "../../drivers/ultrasonic/hc_sr04p_conv.h"
 
 typedef struct {
     int trigger_pin;
@@ -38,7 +42,7 @@ int test_distance_calculation_basic(void) {
     int time_us = 580;
     int expected_distance_mm = 100;  // 10cm = 100mm
     
-    int calculated_distance_mm = (time_us * 10) / 58;
+    int calculated_distance_mm = hc_sr04p_pulse_to_mm(time_us * 1000LL);
     
     if (calculated_distance_mm != expected_distance_mm) {
         TEST_FAIL("Basic calculation mismatch");
@@ -54,25 +58,30 @@ int test_distance_calculation_edge_cases(void) {
     
     // 최소 거리: 20μs (약 3.4mm)
     int min_time_us = 20;
-    int min_distance_mm = (min_time_us * 10) / 58;
+    int min_distance_mm = hc_sr04p_pulse_to_mm(min_time_us * 1000LL);
     if (min_distance_mm < 3 || min_distance_mm > 5) {
         TEST_FAIL("Minimum distance calculation");
     }
     
     // 최대 거리: 38000μs (약 6.55m)
     int max_time_us = 38000;
-    int max_distance_mm = (max_time_us * 10) / 58;
+    int max_distance_mm = hc_sr04p_pulse_to_mm(max_time_us * 1000LL);
     if (max_distance_mm < 6500 || max_distance_mm > 6600) {
         TEST_FAIL("Maximum distance calculation");
     }
     
-    // 무효한 값: 0μs
+    // 무효한 값: 0μs, 범위 밖 (-1 반환)
     int invalid_time_us = 0;
-    int invalid_distance_mm = (invalid_time_us * 10) / 58;
-    if (invalid_distance_mm != 0) {
+    int invalid_distance_mm = hc_sr04p_pulse_to_mm(invalid_time_us * 1000LL);
+    if (invalid_distance_mm != -1) {
         TEST_FAIL("Zero time handling");
     }
     
+    if (hc_sr04p_pulse_to_mm(19999) != -1 || hc_sr04p_pulse_to_mm(38001000LL) != -1 ||
+        hc_sr04p_pulse_to_mm(38000999LL) != max_distance_mm) {
+        TEST_FAIL("Range boundary handling");
+    }
+    
     TEST_PASS();
     return 0;
 }
@@ -95,7 +104,7 @@ int test_distance_precision(void) {
     };
     
     for (int i = 0; i < 6; i++) {
-        int calculated = (test_cases[i].time_us * 10) / 58;
+        int calculated = hc_sr04p_pulse_to_mm(test_cases[i].time_us * 1000LL);
         int diff = abs(calculated - test_cases[i].expected_mm);
         
         // ±5mm 오차 허용
@@ -169,6 +178,37 @@ int test_trigger_pulse_simulation(void) {
     return 0;
 }
 
+// 바이너리 레코드 레이아웃 테스트 (사용자 공간과 커널이 같은 크기를 봐야 함)
+int test_sample_record_layout(void) {
+    TEST_START("Binary record and ring layout");
+    
+    if (sizeof(struct hc_sr04p_sample) != 32) {
+        TEST_FAIL("Record size must be 32 bytes");
+    }
+    
+    if (offsetof(struct hc_sr04p_sample, pulse_end_ns) != 8 ||
+        offsetof(struct hc_sr04p_sample, distance_mm) != 16 ||
+        offsetof(struct hc_sr04p_sample, seq) != 24) {
+        TEST_FAIL("Unexpected field offsets");
+    }
+    
+    // mmap 링: head(커널)와 tail(사용자)은 서로 다른 캐시 라인
+    if (offsetof(struct hc_sr04p_ring, tail) != 64 || sizeof(struct hc_sr04p_ring) != 128) {
+        TEST_FAIL("Unexpected ring header layout");
+    }
+    
+    // GET_LATEST 인자: 레코드가 8바이트 정렬 위치에 포함
+    if (offsetof(struct hc_sr04p_latest, sample) != 8 || sizeof(struct hc_sr04p_latest) != 40) {
+        TEST_FAIL("Unexpected GET_LATEST argument layout");
+    }
+    
+    if (sizeof(struct hc_sr04p_event) != 16 || sizeof(struct hc_sr04p_presence) != 16) {
+        TEST_FAIL("Unexpected presence event/config layout");
+    }
+    
+    TEST_PASS();
+    return 0;
+}
 
 // 메인 테스트 함수
 int main(void) {
@@ -181,6 +221,7 @@ int main(void) {
     if (test_distance_precision() != 0) return 1;
     if (test_gpio_setup() != 0) return 1;
     if (test_trigger_pulse_simulation() != 0) return 1;
+    if (test_sample_record_layout() != 0) return 1;
     
     // 결과 요약
     printf("\n📊 Test Results Summary\n");